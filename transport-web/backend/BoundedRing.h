@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free multi-producer/multi-consumer FIFO of trivially
+// copyable items, the same sequence-numbered cell scheme as PassengerRing
+// without its snapshot reads. A cell's payload is only touched by the one
+// thread that won it with the CAS, so it needs no atomics of its own.
+template <typename T>
+class BoundedRing {
+public:
+    // Capacity is rounded up to a power of two
+    explicit BoundedRing(size_t capacity = 1 << 14) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // False when the ring is full
+    bool push(const T& item) {
+        size_t pos = tail.value.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t lag = intptr_t(sequence) - intptr_t(pos);
+            if (lag == 0) {
+                if (tail.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.item = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                pos = tail.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // False when the ring is empty
+    bool pop(T& out) {
+        size_t pos = head.value.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t lag = intptr_t(sequence) - intptr_t(pos + 1);
+            if (lag == 0) {
+                if (head.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = cell.item;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                pos = head.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Approximate while producers or consumers are running
+    size_t size() const {
+        size_t h = head.value.load(std::memory_order_acquire);
+        size_t t = tail.value.load(std::memory_order_acquire);
+        return t > h ? t - h : 0;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct alignas(64) Cursor {
+        std::atomic<size_t> value{0};
+    };
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    Cursor head;
+    Cursor tail;
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "RoutingGraph.h"
+#include "StationIndex.h"
+
+// Stations and routes from one import request, held column by column so
+// validation runs over flat arrays
+struct ImportBatch {
+    std::vector<StationId> stationIds;
+    std::vector<std::string> stationNames;
+    std::vector<double> stationLats; // NaN when not given; empty when no station has coordinates
+    std::vector<double> stationLons;
+    std::vector<StationId> routeSources;
+    std::vector<StationId> routeDests;
+    std::vector<int64_t> routeWeights;
+};
+
+struct ImportIssue {
+    std::string kind; // "station" or "route"
+    size_t index;     // position in the request array
+    std::string reason;
+};
+
+// Checks a batch against the graph it will be merged into. Stations need a
+// name, and coordinates, if any, as an in-range lat/lon pair. Routes must
+// have a non-negative weight that fits the graph's 32-bit arcs, two
+// distinct endpoints, and endpoints that already exist or arrive in the same
+// batch. Reports at most `maxIssues` problems; an empty result means the
+// batch is valid.
+inline std::vector<ImportIssue> validateImport(const ImportBatch& batch, const RoutingGraph& graph,
+                                               size_t maxIssues = 20) {
+    std::vector<ImportIssue> issues;
+    for (size_t i = 0; i < batch.stationNames.size() && issues.size() < maxIssues; ++i) {
+        if (batch.stationNames[i].empty()) issues.push_back({"station", i, "Empty station name"});
+    }
+    for (size_t i = 0; i < batch.stationLats.size() && issues.size() < maxIssues; ++i) {
+        double lat = batch.stationLats[i], lon = batch.stationLons[i];
+        if (std::isnan(lat) && std::isnan(lon)) continue;
+        if (!(lat >= -90 && lat <= 90 && lon >= -180 && lon <= 180)) {
+            issues.push_back({"station", i, "Coordinates need lat in [-90, 90] and lon in [-180, 180]"});
+        }
+    }
+
+    // Flag pass over the route columns: no lookups or branches, so the
+    // compiler vectorizes it
+    const size_t n = batch.routeSources.size();
+    std::vector<uint8_t> flags(n);
+    const StationId* src = batch.routeSources.data();
+    const StationId* dst = batch.routeDests.data();
+    const int64_t* weight = batch.routeWeights.data();
+    for (size_t i = 0; i < n; ++i) {
+        flags[i] = uint8_t(weight[i] < 0 || weight[i] > INT32_MAX) | uint8_t(src[i] == dst[i]) << 1;
+    }
+
+    // Endpoint pass: resolve against the graph, then the batch's own stations
+    std::vector<StationId> incoming(batch.stationIds);
+    std::sort(incoming.begin(), incoming.end());
+    incoming.erase(std::unique(incoming.begin(), incoming.end()), incoming.end());
+    StationIndex batchStations;
+    batchStations.assign(incoming);
+    auto known = [&](StationId id) {
+        return graph.indexOf(id) != RoutingGraph::NONE || batchStations.indexOf(id) != StationIndex::NONE;
+    };
+    for (size_t i = 0; i < n; ++i) {
+        if (!known(src[i]) || !known(dst[i])) flags[i] |= 4;
+    }
+
+    for (size_t i = 0; i < n && issues.size() < maxIssues; ++i) {
+        if (!flags[i]) continue;
+        const char* reason = flags[i] & 4 ? "Unknown station"
+                           : flags[i] & 2 ? "Route loops onto the same station"
+                                          : "Weight must be between 0 and 2147483647";
+        issues.push_back({"route", i, reason});
+    }
+    return issues;
+}
+
+// The same checks for a single route: why it cannot join the network, or
+// nullptr when it can. `known(id)` says whether a station exists.
+template <typename Known>
+const char* routeIssue(StationId source, StationId dest, int64_t weight, Known known) {
+    if (!known(source) || !known(dest)) return "Unknown station";
+    if (source == dest) return "Route loops onto the same station";
+    if (weight < 0 || weight > INT32_MAX) return "Weight must be between 0 and 2147483647";
+    return nullptr;
+}
+
+// Unordered station pair identifying a bidirectional route
+struct RoutePairHash {
+    size_t operator()(const std::pair<StationId, StationId>& pair) const {
+        uint64_t h = uint64_t(pair.first) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (uint64_t(pair.second) + (h << 6) + (h >> 2)));
+    }
+};
+
+inline std::pair<StationId, StationId> routePair(StationId a, StationId b) {
+    return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+}
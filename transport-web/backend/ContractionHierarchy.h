@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "FlatArray.h"
+#include "RoutingGraph.h"
+
+// Contraction Hierarchies over a RoutingGraph.
+// Nodes are contracted in order of a lazily updated importance (edge
+// difference + contracted neighbours); shortcuts are added only when a
+// bounded witness search fails. Because routes are bidirectional a single
+// upward graph serves both the forward and the backward search.
+class ContractionHierarchy {
+public:
+    using PathResult = RoutingGraph::PathResult;
+
+    explicit ContractionHierarchy(const RoutingGraph& graph, uint64_t version = 0)
+        : graphVersion(version) {
+        std::vector<StationId> stationIds(graph.nodeCount());
+        for (uint32_t v = 0; v < graph.nodeCount(); ++v) stationIds[v] = graph.stationAt(v);
+        ids = std::move(stationIds);
+        contract(graph);
+    }
+
+    // Version of the routing graph this hierarchy was built from
+    uint64_t version() const { return graphVersion; }
+    uint32_t nodeCount() const { return static_cast<uint32_t>(ids.size()); }
+    uint32_t shortcutCount() const { return shortcuts; }
+
+    // Bidirectional upward Dijkstra; shortcuts are unpacked into the real
+    // station sequence. `start`/`end` are dense indices of the source graph.
+    PathResult query(uint32_t s, uint32_t t) const {
+        PathResult result;
+        if (s >= nodeCount() || t >= nodeCount()) return result;
+
+        Scratch& fwd = scratch(0);
+        Scratch& bwd = scratch(1);
+        fwd.reset(nodeCount());
+        bwd.reset(nodeCount());
+
+        using Entry = std::pair<int64_t, uint32_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> fq, bq;
+        fwd.relax(s, 0, RoutingGraph::NONE);
+        bwd.relax(t, 0, RoutingGraph::NONE);
+        fq.push({0, s});
+        bq.push({0, t});
+
+        int64_t best = RoutingGraph::INF;
+        uint32_t meet = RoutingGraph::NONE;
+        while (!fq.empty() || !bq.empty()) {
+            if (!fq.empty() && fq.top().first >= best) fq = {};
+            if (!bq.empty() && bq.top().first >= best) bq = {};
+            bool forward = !fq.empty() && (bq.empty() || fq.top().first <= bq.top().first);
+            if (!forward && bq.empty()) break;
+
+            auto& q = forward ? fq : bq;
+            Scratch& mine = forward ? fwd : bwd;
+            const Scratch& other = forward ? bwd : fwd;
+            auto [d, u] = q.top();
+            q.pop();
+            if (d > mine.dist[u]) continue;
+            if (other.dist[u] != RoutingGraph::INF && d + other.dist[u] < best) {
+                best = d + other.dist[u];
+                meet = u;
+            }
+            for (uint32_t e = upOffsets[u]; e < upOffsets[u + 1]; ++e) {
+                int64_t nd = d + up[e].weight;
+                if (nd < mine.dist[up[e].to]) {
+                    mine.relax(up[e].to, nd, e);
+                    q.push({nd, up[e].to});
+                }
+            }
+        }
+
+        if (meet == RoutingGraph::NONE) return result;
+        result.found = true;
+        result.distance = best;
+
+        // Upward arcs from s to the meeting node, then back down to t
+        std::vector<uint32_t> fwdArcs, bwdArcs;
+        for (uint32_t v = meet; fwd.parentArc[v] != RoutingGraph::NONE; v = up[fwd.parentArc[v]].from) {
+            fwdArcs.push_back(fwd.parentArc[v]);
+        }
+        for (uint32_t v = meet; bwd.parentArc[v] != RoutingGraph::NONE; v = up[bwd.parentArc[v]].from) {
+            bwdArcs.push_back(bwd.parentArc[v]);
+        }
+        std::reverse(fwdArcs.begin(), fwdArcs.end());
+
+        std::vector<uint32_t> nodes{s};
+        for (uint32_t e : fwdArcs) unpack(up[e].from, up[e].to, up[e].middle, nodes);
+        for (uint32_t e : bwdArcs) unpack(up[e].to, up[e].from, up[e].middle, nodes);
+        for (uint32_t v : nodes) result.path.push_back(ids[v]);
+        return result;
+    }
+
+    // Every node settled by a full upward search from `node`, with its
+    // upward distance. Building block for bucket-based many-to-many.
+    void upwardSpace(uint32_t node, std::vector<std::pair<uint32_t, int64_t>>& out) const {
+        out.clear();
+        if (node >= nodeCount()) return;
+        Scratch& sc = scratch(0);
+        sc.reset(nodeCount());
+
+        using Entry = std::pair<int64_t, uint32_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+        sc.relax(node, 0, RoutingGraph::NONE);
+        pq.push({0, node});
+        while (!pq.empty()) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (d > sc.dist[u]) continue;
+            out.push_back({u, d});
+            for (uint32_t e = upOffsets[u]; e < upOffsets[u + 1]; ++e) {
+                int64_t nd = d + up[e].weight;
+                if (nd < sc.dist[up[e].to]) {
+                    sc.relax(up[e].to, nd, e);
+                    pq.push({nd, up[e].to});
+                }
+            }
+        }
+    }
+
+private:
+    friend class NetworkSnapshot;
+
+    // Empty hierarchy for NetworkSnapshot to fill in
+    explicit ContractionHierarchy(uint64_t version) : graphVersion(version) {}
+
+    struct UpArc {
+        uint32_t from;
+        uint32_t to;
+        uint32_t weight;
+        uint32_t middle; // contracted node a shortcut bypasses, NONE for real routes
+    };
+
+    struct Arc {
+        uint32_t to;
+        uint32_t weight;
+        uint32_t middle;
+    };
+
+    struct Scratch {
+        std::vector<int64_t> dist;
+        std::vector<uint32_t> parentArc;
+        std::vector<uint32_t> touched;
+
+        void reset(uint32_t n) {
+            if (dist.size() != n) {
+                dist.assign(n, RoutingGraph::INF);
+                parentArc.assign(n, RoutingGraph::NONE);
+                touched.clear();
+                return;
+            }
+            for (uint32_t v : touched) {
+                dist[v] = RoutingGraph::INF;
+                parentArc[v] = RoutingGraph::NONE;
+            }
+            touched.clear();
+        }
+
+        void relax(uint32_t v, int64_t d, uint32_t arc) {
+            if (dist[v] == RoutingGraph::INF) touched.push_back(v);
+            dist[v] = d;
+            parentArc[v] = arc;
+        }
+    };
+
+    // Per-thread search state so concurrent queries never share buffers
+    static Scratch& scratch(int side) {
+        thread_local Scratch buffers[2];
+        return buffers[side];
+    }
+
+    // Witness searches are cut off after this many settled nodes; the cheaper
+    // limit is used when only estimating a node's importance
+    static constexpr uint32_t WITNESS_SETTLE_LIMIT = 500;
+    static constexpr uint32_t ESTIMATE_SETTLE_LIMIT = 40;
+
+    FlatArray<StationId> ids;
+    FlatArray<uint32_t> rank;
+    FlatArray<uint32_t> upOffsets;
+    FlatArray<UpArc> up;
+    uint32_t shortcuts = 0;
+    uint64_t graphVersion;
+
+    // Remaining graph during contraction
+    std::vector<std::vector<Arc>> adj;
+    std::vector<char> contracted;
+    std::vector<uint32_t> contractedNeighbours;
+    std::vector<uint32_t> level;
+    std::vector<char> isTarget;
+    Scratch witness;
+
+    static void upsertArc(std::vector<Arc>& list, uint32_t to, uint32_t weight, uint32_t middle) {
+        for (Arc& arc : list) {
+            if (arc.to == to) {
+                if (weight < arc.weight) { arc.weight = weight; arc.middle = middle; }
+                return;
+            }
+        }
+        list.push_back({to, weight, middle});
+    }
+
+    // Bounded Dijkstra from `source` that avoids `skip`; fills witness.dist.
+    // Stops early once all `targets` nodes are settled.
+    void witnessSearch(uint32_t source, uint32_t skip, int64_t limit, uint32_t settleLimit,
+                       uint32_t targets) {
+        witness.reset(nodeCount());
+        using Entry = std::pair<int64_t, uint32_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+        witness.relax(source, 0, RoutingGraph::NONE);
+        pq.push({0, source});
+        uint32_t settled = 0;
+        while (!pq.empty() && settled < settleLimit) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (d > witness.dist[u]) continue;
+            if (d > limit) break;
+            ++settled;
+            if (isTarget[u] && --targets == 0) break;
+            for (const Arc& arc : adj[u]) {
+                if (arc.to == skip || contracted[arc.to]) continue;
+                int64_t nd = d + arc.weight;
+                if (nd < witness.dist[arc.to]) {
+                    witness.relax(arc.to, nd, RoutingGraph::NONE);
+                    pq.push({nd, arc.to});
+                }
+            }
+        }
+    }
+
+    // Shortcuts needed to contract v; applied when `apply` is set
+    int contractNode(uint32_t v, bool apply) {
+        int added = 0;
+        const std::vector<Arc>& neighbours = adj[v];
+        for (size_t i = 0; i < neighbours.size(); ++i) {
+            const Arc& in = neighbours[i];
+            if (i + 1 == neighbours.size()) break;
+            int64_t limit = 0;
+            for (size_t j = i + 1; j < neighbours.size(); ++j) {
+                limit = std::max<int64_t>(limit, int64_t(in.weight) + neighbours[j].weight);
+                isTarget[neighbours[j].to] = 1;
+            }
+            witnessSearch(in.to, v, limit, apply ? WITNESS_SETTLE_LIMIT : ESTIMATE_SETTLE_LIMIT,
+                          static_cast<uint32_t>(neighbours.size() - i - 1));
+            for (size_t j = i + 1; j < neighbours.size(); ++j) isTarget[neighbours[j].to] = 0;
+            for (size_t j = i + 1; j < neighbours.size(); ++j) {
+                const Arc& out = neighbours[j];
+                int64_t viaV = int64_t(in.weight) + out.weight;
+                if (witness.dist[out.to] <= viaV) continue;
+                ++added;
+                if (apply) {
+                    upsertArc(adj[in.to], out.to, static_cast<uint32_t>(viaV), v);
+                    upsertArc(adj[out.to], in.to, static_cast<uint32_t>(viaV), v);
+                }
+            }
+        }
+        return added;
+    }
+
+    int64_t priority(uint32_t v) {
+        int64_t added = contractNode(v, false);
+        return added * 2 - int64_t(adj[v].size()) + contractedNeighbours[v] + level[v];
+    }
+
+    void contract(const RoutingGraph& graph) {
+        const uint32_t n = graph.nodeCount();
+        adj.assign(n, {});
+        for (uint32_t u = 0; u < n; ++u) {
+            for (uint32_t e = graph.arcBegin(u); e < graph.arcEnd(u); ++e) {
+                upsertArc(adj[u], graph.arcTarget(e), graph.arcWeight(e), RoutingGraph::NONE);
+            }
+        }
+        contracted.assign(n, 0);
+        contractedNeighbours.assign(n, 0);
+        std::vector<uint32_t> ranks(n, 0);
+        level.assign(n, 0);
+        isTarget.assign(n, 0);
+
+        using Entry = std::pair<int64_t, uint32_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> order;
+        for (uint32_t v = 0; v < n; ++v) order.push({priority(v), v});
+
+        std::vector<std::vector<Arc>> upward(n);
+        uint32_t nextRank = 0;
+        while (!order.empty()) {
+            auto [p, v] = order.top();
+            order.pop();
+            if (contracted[v]) continue;
+            // Lazy update: re-queue if the node became more important
+            int64_t current = priority(v);
+            if (!order.empty() && current > order.top().first) {
+                order.push({current, v});
+                continue;
+            }
+
+            shortcuts += contractNode(v, true);
+            contracted[v] = 1;
+            ranks[v] = nextRank++;
+            upward[v] = adj[v];
+            for (const Arc& arc : adj[v]) {
+                auto& list = adj[arc.to];
+                list.erase(std::remove_if(list.begin(), list.end(),
+                                          [v](const Arc& a) { return a.to == v; }),
+                           list.end());
+                ++contractedNeighbours[arc.to];
+                level[arc.to] = std::max(level[arc.to], level[v] + 1);
+            }
+            adj[v].clear();
+        }
+
+        std::vector<uint32_t> offsets(n + 1, 0);
+        for (uint32_t v = 0; v < n; ++v) offsets[v + 1] = offsets[v] + upward[v].size();
+        std::vector<UpArc> arcs;
+        arcs.reserve(offsets[n]);
+        for (uint32_t v = 0; v < n; ++v) {
+            for (const Arc& arc : upward[v]) arcs.push_back({v, arc.to, arc.weight, arc.middle});
+        }
+        rank = std::move(ranks);
+        upOffsets = std::move(offsets);
+        up = std::move(arcs);
+
+        adj = {};
+        contracted = {};
+        contractedNeighbours = {};
+        level = {};
+        isTarget = {};
+        witness = {};
+    }
+
+    // Weight-minimal upward arc between a and b (the lower-ranked one owns it)
+    const UpArc* findArc(uint32_t a, uint32_t b) const {
+        uint32_t low = rank[a] < rank[b] ? a : b;
+        uint32_t high = low == a ? b : a;
+        for (uint32_t e = upOffsets[low]; e < upOffsets[low + 1]; ++e) {
+            if (up[e].to == high) return &up[e];
+        }
+        return nullptr;
+    }
+
+    // Append the real nodes of arc a->b (excluding a) to `out`
+    void unpack(uint32_t a, uint32_t b, uint32_t middle, std::vector<uint32_t>& out) const {
+        // Explicit stack of pending (from, to, middle) segments, leftmost first
+        std::vector<UpArc> stack{{a, b, 0, middle}};
+        while (!stack.empty()) {
+            UpArc seg = stack.back();
+            stack.pop_back();
+            if (seg.middle == RoutingGraph::NONE) {
+                out.push_back(seg.to);
+                continue;
+            }
+            const UpArc* first = findArc(seg.from, seg.middle);
+            const UpArc* second = findArc(seg.middle, seg.to);
+            stack.push_back({seg.middle, seg.to, 0, second ? second->middle : RoutingGraph::NONE});
+            stack.push_back({seg.from, seg.middle, 0, first ? first->middle : RoutingGraph::NONE});
+        }
+    }
+};
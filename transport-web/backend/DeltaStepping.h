@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Parallel.h"
+#include "PriorityQueue.h"
+#include "RoutingGraph.h"
+
+// Parallel one-to-all shortest paths by delta-stepping (Meyer & Sanders).
+// Tentative distances are grouped into buckets of width `delta`. The
+// lowest bucket is emptied by repeatedly relaxing its light arcs
+// (weight <= delta) in parallel, since those can refill it; heavy arcs are
+// relaxed once afterwards because they always land in later buckets.
+// Workers stay alive for the whole search and step through phases in
+// lockstep; worker 0 merges their discoveries into the buckets between
+// phases.
+class DeltaStepping {
+public:
+    // Graphs smaller than this are searched with sequential Dijkstra
+    static constexpr uint32_t PARALLEL_THRESHOLD = 50'000;
+
+    // Fill `dist` with distances from `source` (INF when unreachable or
+    // beyond `limit`). `delta` 0 picks a width from the arc weights.
+    static void run(const RoutingGraph& graph, uint32_t source, std::vector<int64_t>& dist,
+                    int64_t limit = RoutingGraph::INF, unsigned threads = 0, int64_t delta = 0) {
+        const uint32_t n = graph.nodeCount();
+        if (threads == 0) threads = n >= PARALLEL_THRESHOLD ? workerCount(n) : 1;
+        if (threads <= 1 || source >= n) {
+            graph.oneToAll<RadixHeap>(source, dist);
+            if (limit != RoutingGraph::INF) {
+                for (int64_t& d : dist) if (d > limit) d = RoutingGraph::INF;
+            }
+            return;
+        }
+
+        Search search(graph, limit, threads, delta > 0 ? delta : defaultDelta(graph));
+        search.start(source);
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back([&search, t]() { search.work(t); });
+        search.work(0);
+        for (auto& thread : pool) thread.join();
+
+        dist.resize(n);
+        for (uint32_t v = 0; v < n; ++v) dist[v] = search.dist[v].load(std::memory_order_relaxed);
+    }
+
+private:
+    // A few average arcs per bucket keeps phases short without making the
+    // light-arc rounds re-relax too much
+    static int64_t defaultDelta(const RoutingGraph& graph) {
+        if (graph.arcCount() == 0) return 1;
+        uint64_t total = 0;
+        for (uint32_t e = 0; e < graph.arcCount(); ++e) total += graph.arcWeight(e);
+        return std::max<int64_t>(1, int64_t(3 * total / graph.arcCount()));
+    }
+
+    // Reusable spinning barrier; phases are short, so sleeping would cost more
+    class Barrier {
+    public:
+        explicit Barrier(unsigned count) : count(count) {}
+
+        void wait() {
+            unsigned gen = generation.load(std::memory_order_acquire);
+            if (waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                waiting.store(0, std::memory_order_relaxed);
+                generation.fetch_add(1, std::memory_order_release);
+                return;
+            }
+            while (generation.load(std::memory_order_acquire) == gen) std::this_thread::yield();
+        }
+
+    private:
+        unsigned count;
+        std::atomic<unsigned> waiting{0};
+        std::atomic<unsigned> generation{0};
+    };
+
+    struct Search {
+        const RoutingGraph& graph;
+        const int64_t limit;
+        const int64_t delta;
+        std::unique_ptr<std::atomic<int64_t>[]> dist;
+        Barrier barrier;
+
+        std::vector<std::vector<uint32_t>> buckets; // lazily deduplicated
+        size_t current = 0;
+        std::vector<uint32_t> frontier;
+        std::vector<uint32_t> removed;  // left the current bucket; need heavy arcs
+        std::vector<uint32_t> stamp;    // last frontier/removed round a node joined
+        uint32_t round = 0;
+        bool heavyPhase = false;
+        bool done = false;
+        std::atomic<size_t> next{0};
+        std::vector<std::vector<uint32_t>> discovered; // per worker
+
+        Search(const RoutingGraph& graph, int64_t limit, unsigned threads, int64_t delta)
+            : graph(graph), limit(limit), delta(delta),
+              dist(new std::atomic<int64_t>[graph.nodeCount()]), barrier(threads),
+              stamp(graph.nodeCount(), 0), discovered(threads) {
+            for (uint32_t v = 0; v < graph.nodeCount(); ++v) {
+                dist[v].store(RoutingGraph::INF, std::memory_order_relaxed);
+            }
+        }
+
+        void start(uint32_t source) {
+            dist[source].store(0, std::memory_order_relaxed);
+            buckets.assign(1, {source});
+            current = 0;
+            openBucket();
+        }
+
+        void work(unsigned worker) {
+            const size_t CHUNK = 128;
+            std::vector<uint32_t>& out = discovered[worker];
+            for (;;) {
+                for (size_t i = next.fetch_add(CHUNK); i < frontier.size(); i = next.fetch_add(CHUNK)) {
+                    size_t end = std::min(frontier.size(), i + CHUNK);
+                    for (size_t k = i; k < end; ++k) relax(frontier[k], out);
+                }
+                barrier.wait();
+                if (worker == 0) advance();
+                barrier.wait();
+                if (done) return;
+            }
+        }
+
+        void relax(uint32_t u, std::vector<uint32_t>& out) {
+            const int64_t du = dist[u].load(std::memory_order_relaxed);
+            for (uint32_t e = graph.arcBegin(u); e < graph.arcEnd(u); ++e) {
+                int64_t w = graph.arcWeight(e);
+                if ((w > delta) != heavyPhase) continue;
+                int64_t nd = du + w;
+                if (nd > limit) continue;
+                std::atomic<int64_t>& slot = dist[graph.arcTarget(e)];
+                int64_t seen = slot.load(std::memory_order_relaxed);
+                while (nd < seen) {
+                    if (slot.compare_exchange_weak(seen, nd, std::memory_order_relaxed)) {
+                        out.push_back(graph.arcTarget(e));
+                        break;
+                    }
+                }
+            }
+        }
+
+        size_t bucketOf(uint32_t v) const {
+            return static_cast<size_t>(dist[v].load(std::memory_order_relaxed) / delta);
+        }
+
+        // Worker 0 only, between barriers: file discoveries and pick the
+        // next phase
+        void advance() {
+            if (!heavyPhase) removed.insert(removed.end(), frontier.begin(), frontier.end());
+            ++round;
+            frontier.clear();
+            for (auto& out : discovered) {
+                for (uint32_t v : out) {
+                    size_t b = bucketOf(v);
+                    if (b == current) {
+                        if (stamp[v] != round) {
+                            stamp[v] = round;
+                            frontier.push_back(v);
+                        }
+                    } else {
+                        if (b >= buckets.size()) buckets.resize(b + 1);
+                        buckets[b].push_back(v);
+                    }
+                }
+                out.clear();
+            }
+            next.store(0, std::memory_order_relaxed);
+
+            if (!heavyPhase && !frontier.empty()) return; // bucket refilled
+            if (!heavyPhase) {
+                // Bucket settled: relax heavy arcs of everything it held
+                heavyPhase = true;
+                ++round;
+                for (uint32_t v : removed) {
+                    if (stamp[v] != round) {
+                        stamp[v] = round;
+                        frontier.push_back(v);
+                    }
+                }
+                removed.clear();
+                return;
+            }
+            heavyPhase = false;
+            ++current;
+            openBucket();
+        }
+
+        // Move to the first bucket with live entries and make it the frontier
+        void openBucket() {
+            ++round;
+            for (; current < buckets.size(); ++current) {
+                if (int64_t(current) * delta > limit) break;
+                for (uint32_t v : buckets[current]) {
+                    if (bucketOf(v) == current && stamp[v] != round) {
+                        stamp[v] = round;
+                        frontier.push_back(v);
+                    }
+                }
+                std::vector<uint32_t>().swap(buckets[current]);
+                if (!frontier.empty()) return;
+            }
+            done = true;
+        }
+    };
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Dial's bucket queue for monotone integer priorities. With arc weights in
+// [0, C] every key pending at once lies in [current, current + C], so C + 1
+// circular buckets suffice and push/pop are O(1) amortized. Entries are not
+// decreased in place; a stale copy is skipped by the caller when popped.
+class DialQueue {
+public:
+    explicit DialQueue(uint32_t maxWeight) : buckets(size_t(maxWeight) + 1) {}
+
+    bool empty() const { return pending == 0; }
+
+    // `key` must lie in [current, current + maxWeight]
+    void push(uint32_t node, uint64_t key) {
+        buckets[key % buckets.size()].push_back(node);
+        ++pending;
+    }
+
+    // Pop a node with the smallest key
+    std::pair<uint32_t, uint64_t> pop() {
+        while (cursorBucket().empty()) ++current;
+        std::vector<uint32_t>& bucket = cursorBucket();
+        uint32_t node = bucket.back();
+        bucket.pop_back();
+        --pending;
+        return {node, current};
+    }
+
+private:
+    std::vector<std::vector<uint32_t>> buckets;
+    uint64_t current = 0;
+    size_t pending = 0;
+
+    std::vector<uint32_t>& cursorBucket() { return buckets[current % buckets.size()]; }
+};
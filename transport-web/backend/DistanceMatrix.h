@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "ContractionHierarchy.h"
+#include "DeltaStepping.h"
+#include "Parallel.h"
+#include "RoutingGraph.h"
+
+// Many-to-many shortest distances. Rows follow `sources`, columns follow
+// `targets` (dense node indices); unreachable pairs hold RoutingGraph::INF.
+class DistanceMatrix {
+public:
+    using Matrix = std::vector<std::vector<int64_t>>;
+
+    // Bucket-based many-to-many on a contraction hierarchy: one upward search
+    // per target fills per-node buckets, then one upward search per source
+    // scans the buckets of every node it settles.
+    static Matrix withHierarchy(const ContractionHierarchy& ch,
+                                const std::vector<uint32_t>& sources,
+                                const std::vector<uint32_t>& targets) {
+        struct BucketEntry {
+            uint32_t node;
+            uint32_t column;
+            int64_t dist;
+        };
+
+        std::vector<std::vector<std::pair<uint32_t, int64_t>>> spaces(targets.size());
+        parallelFor(targets.size(), [&](size_t j) { ch.upwardSpace(targets[j], spaces[j]); });
+
+        std::vector<BucketEntry> entries;
+        for (uint32_t j = 0; j < targets.size(); ++j) {
+            for (const auto& [node, dist] : spaces[j]) entries.push_back({node, j, dist});
+        }
+        spaces = {};
+        std::sort(entries.begin(), entries.end(),
+                  [](const BucketEntry& a, const BucketEntry& b) { return a.node < b.node; });
+
+        // bucketStart[v] .. bucketStart[v + 1] indexes the entries of node v
+        std::vector<uint32_t> bucketStart(ch.nodeCount() + 1, 0);
+        for (const auto& entry : entries) ++bucketStart[entry.node + 1];
+        for (uint32_t v = 0; v < ch.nodeCount(); ++v) bucketStart[v + 1] += bucketStart[v];
+
+        Matrix matrix(sources.size(), std::vector<int64_t>(targets.size(), RoutingGraph::INF));
+        parallelFor(sources.size(), [&](size_t i) {
+            std::vector<std::pair<uint32_t, int64_t>> space;
+            ch.upwardSpace(sources[i], space);
+            std::vector<int64_t>& row = matrix[i];
+            for (const auto& [node, dist] : space) {
+                for (uint32_t b = bucketStart[node]; b < bucketStart[node + 1]; ++b) {
+                    row[entries[b].column] = std::min(row[entries[b].column], dist + entries[b].dist);
+                }
+            }
+        });
+        return matrix;
+    }
+
+    // One Dijkstra per source, spread across cores; each search stops as soon
+    // as every target has been settled. With fewer sources than cores on a
+    // large graph, the cores go to one delta-stepping search per source.
+    static Matrix withDijkstra(const RoutingGraph& graph,
+                               const std::vector<uint32_t>& sources,
+                               const std::vector<uint32_t>& targets) {
+        Matrix matrix(sources.size(), std::vector<int64_t>(targets.size(), RoutingGraph::INF));
+        if (graph.nodeCount() >= DeltaStepping::PARALLEL_THRESHOLD &&
+            sources.size() < workerCount(graph.nodeCount())) {
+            std::vector<int64_t> dist;
+            for (size_t i = 0; i < sources.size(); ++i) {
+                DeltaStepping::run(graph, sources[i], dist);
+                for (size_t j = 0; j < targets.size(); ++j) matrix[i][j] = dist[targets[j]];
+            }
+            return matrix;
+        }
+
+        // column lists per target node (a node may appear more than once)
+        std::vector<std::vector<uint32_t>> columnsOf;
+        std::vector<uint32_t> targetSlot(graph.nodeCount(), RoutingGraph::NONE);
+        for (uint32_t j = 0; j < targets.size(); ++j) {
+            if (targetSlot[targets[j]] == RoutingGraph::NONE) {
+                targetSlot[targets[j]] = static_cast<uint32_t>(columnsOf.size());
+                columnsOf.emplace_back();
+            }
+            columnsOf[targetSlot[targets[j]]].push_back(j);
+        }
+
+        parallelFor(sources.size(), [&](size_t i) {
+            std::vector<int64_t> dist(graph.nodeCount(), RoutingGraph::INF);
+            using Entry = std::pair<int64_t, uint32_t>;
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+            size_t pending = columnsOf.size();
+            dist[sources[i]] = 0;
+            pq.push({0, sources[i]});
+            while (!pq.empty() && pending > 0) {
+                auto [d, u] = pq.top();
+                pq.pop();
+                if (d > dist[u]) continue;
+                if (targetSlot[u] != RoutingGraph::NONE) {
+                    for (uint32_t column : columnsOf[targetSlot[u]]) matrix[i][column] = d;
+                    --pending;
+                }
+                for (uint32_t e = graph.arcBegin(u); e < graph.arcEnd(u); ++e) {
+                    uint32_t v = graph.arcTarget(e);
+                    int64_t nd = d + graph.arcWeight(e);
+                    if (nd < dist[v]) {
+                        dist[v] = nd;
+                        pq.push({nd, v});
+                    }
+                }
+            }
+        });
+        return matrix;
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Read-mostly contiguous array that either owns its elements or views memory
+// owned by someone else (a mapped snapshot file), so loaded arrays are used in
+// place. A view keeps its owner alive and copies of it share the memory;
+// mutableData() turns a view into an owned copy first. T must be trivially
+// copyable.
+template <typename T>
+class FlatArray {
+public:
+    FlatArray() = default;
+    FlatArray(std::vector<T> values) : owned(std::move(values)) { point(); }
+
+    FlatArray(const FlatArray& other) : owned(other.owned), owner(other.owner) { point(other); }
+    FlatArray(FlatArray&& other) noexcept : owned(std::move(other.owned)), owner(std::move(other.owner)) {
+        point(other);
+        other.first = nullptr;
+        other.count = 0;
+    }
+    FlatArray& operator=(FlatArray other) noexcept {
+        owned = std::move(other.owned);
+        owner = std::move(other.owner);
+        point(other);
+        return *this;
+    }
+
+    // View `count` elements at `data`, valid while `owner` lives
+    static FlatArray view(std::shared_ptr<const void> owner, const T* data, size_t count) {
+        FlatArray array;
+        array.owner = std::move(owner);
+        array.first = data;
+        array.count = count;
+        return array;
+    }
+
+    const T& operator[](size_t i) const { return first[i]; }
+    const T* data() const { return first; }
+    const T* begin() const { return first; }
+    const T* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool isView() const { return owner != nullptr; }
+
+    T* mutableData() {
+        if (owner) {
+            owned.assign(first, first + count);
+            owner.reset();
+            point();
+        }
+        return owned.data();
+    }
+
+private:
+    std::vector<T> owned;
+    std::shared_ptr<const void> owner;
+    const T* first = nullptr;
+    size_t count = 0;
+
+    void point() {
+        first = owned.data();
+        count = owned.size();
+    }
+
+    void point(const FlatArray& other) {
+        if (owner) {
+            first = other.first;
+            count = other.count;
+        } else {
+            point();
+        }
+    }
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+struct GeoPoint {
+    double lat;
+    double lon;
+};
+
+constexpr double EARTH_RADIUS_M = 6371008.8;
+constexpr double PI = 3.14159265358979323846; // M_PI is not standard C++
+
+inline double toRadians(double degrees) { return degrees * (PI / 180.0); }
+inline double toDegrees(double radians) { return radians * (180.0 / PI); }
+
+// Great-circle distance on a spherical earth
+inline double haversineMeters(GeoPoint a, GeoPoint b) {
+    double dLat = toRadians(b.lat - a.lat);
+    double dLon = toRadians(b.lon - a.lon);
+    double h = std::sin(dLat / 2) * std::sin(dLat / 2) +
+               std::cos(toRadians(a.lat)) * std::cos(toRadians(b.lat)) * std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 2 * EARTH_RADIUS_M * std::asin(std::min(1.0, std::sqrt(h)));
+}
+
+// Lat/lon rectangle holding every point within `meters` of the center on
+// the same sphere haversineMeters() uses. Near a pole or the antimeridian
+// it widens to all longitudes rather than wrap.
+struct GeoBox {
+    double minLat, minLon, maxLat, maxLon;
+
+    static GeoBox around(GeoPoint center, double meters) {
+        double angle = meters / EARTH_RADIUS_M;
+        double dLat = toDegrees(angle);
+        GeoBox box{center.lat - dLat, -180, center.lat + dLat, 180};
+        if (box.minLat > -90 && box.maxLat < 90) {
+            double dLon = toDegrees(std::asin(std::min(1.0, std::sin(angle) / std::cos(toRadians(center.lat)))));
+            if (center.lon - dLon >= -180 && center.lon + dLon <= 180) {
+                box.minLon = center.lon - dLon;
+                box.maxLon = center.lon + dLon;
+            }
+        }
+        box.minLat = std::max(box.minLat, -90.0);
+        box.maxLat = std::min(box.maxLat, 90.0);
+        return box;
+    }
+
+    bool contains(GeoPoint p) const {
+        return p.lat >= minLat && p.lat <= maxLat && p.lon >= minLon && p.lon <= maxLon;
+    }
+};
+
+// Static packed R-tree over points. Points are sorted along a Hilbert curve
+// and grouped NODE_SIZE at a time, level by level, so neighbouring points
+// share nodes and the whole tree is two flat arrays with no pointers: a
+// node's children are the NODE_SIZE entries starting at its index. Built
+// once in O(n log n); rebuild it to change the points.
+class HilbertRTree {
+public:
+    static constexpr uint32_t NODE_SIZE = 16;
+
+    HilbertRTree() = default;
+
+    explicit HilbertRTree(const std::vector<GeoPoint>& points) {
+        size_t n = points.size();
+        if (n == 0) return;
+        GeoBox bounds{90, 180, -90, -180};
+        for (const GeoPoint& p : points) {
+            bounds.minLat = std::min(bounds.minLat, p.lat);
+            bounds.maxLat = std::max(bounds.maxLat, p.lat);
+            bounds.minLon = std::min(bounds.minLon, p.lon);
+            bounds.maxLon = std::max(bounds.maxLon, p.lon);
+        }
+        double scaleLat = bounds.maxLat > bounds.minLat ? 65535 / (bounds.maxLat - bounds.minLat) : 0;
+        double scaleLon = bounds.maxLon > bounds.minLon ? 65535 / (bounds.maxLon - bounds.minLon) : 0;
+        std::vector<uint32_t> curve(n);
+        for (size_t i = 0; i < n; ++i) {
+            curve[i] = hilbert(static_cast<uint32_t>((points[i].lon - bounds.minLon) * scaleLon),
+                               static_cast<uint32_t>((points[i].lat - bounds.minLat) * scaleLat));
+        }
+        std::vector<uint32_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return curve[a] < curve[b]; });
+
+        for (uint32_t item : order) {
+            boxes.push_back({points[item].lat, points[item].lon, points[item].lat, points[item].lon});
+            index.push_back(item);
+        }
+        levelEnds.push_back(boxes.size());
+        for (size_t begin = 0; levelEnds.back() - begin > 1;) {
+            size_t end = levelEnds.back();
+            for (size_t first = begin; first < end; first += NODE_SIZE) {
+                GeoBox box = boxes[first];
+                for (size_t c = first + 1; c < std::min(first + NODE_SIZE, end); ++c) {
+                    box.minLat = std::min(box.minLat, boxes[c].minLat);
+                    box.minLon = std::min(box.minLon, boxes[c].minLon);
+                    box.maxLat = std::max(box.maxLat, boxes[c].maxLat);
+                    box.maxLon = std::max(box.maxLon, boxes[c].maxLon);
+                }
+                boxes.push_back(box);
+                index.push_back(static_cast<uint32_t>(first));
+            }
+            begin = end;
+            levelEnds.push_back(boxes.size());
+        }
+    }
+
+    size_t size() const { return levelEnds.empty() ? 0 : levelEnds[0]; }
+
+    // fn(i) for every point i (position in the build vector) inside `query`
+    template <typename Fn>
+    void search(const GeoBox& query, Fn fn) const {
+        if (boxes.empty()) return;
+        std::vector<std::pair<size_t, size_t>> stack{{boxes.size() - 1, levelEnds.size() - 1}};
+        while (!stack.empty()) {
+            auto [node, level] = stack.back();
+            stack.pop_back();
+            const GeoBox& box = boxes[node];
+            if (box.maxLat < query.minLat || box.minLat > query.maxLat || box.maxLon < query.minLon ||
+                box.minLon > query.maxLon) {
+                continue;
+            }
+            if (level == 0) {
+                fn(index[node]);
+                continue;
+            }
+            size_t end = std::min<size_t>(index[node] + NODE_SIZE, levelEnds[level - 1]);
+            for (size_t child = index[node]; child < end; ++child) stack.emplace_back(child, level - 1);
+        }
+    }
+
+private:
+    std::vector<GeoBox> boxes;     // points in curve order, then each level's nodes
+    std::vector<uint32_t> index;   // point: build position; node: first child
+    std::vector<size_t> levelEnds; // boxes.size() after each level; the root is last
+
+    // Position of (x, y) along a Hilbert curve filling a 65536 x 65536 grid
+    static uint32_t hilbert(uint32_t x, uint32_t y) {
+        const uint32_t n = 1u << 16;
+        uint32_t d = 0;
+        for (uint32_t s = n / 2; s > 0; s /= 2) {
+            uint32_t rx = (x & s) > 0;
+            uint32_t ry = (y & s) > 0;
+            d += s * s * ((3 * rx) ^ ry);
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+};
+
+// Hits within `radius` meters, closest first, as (item, meters). `scan`
+// is called as scan(box, visit) and must call visit(item, point) for at
+// least every item inside the box.
+template <typename Item, typename Scan>
+std::vector<std::pair<Item, double>> withinRadius(GeoPoint center, double radius, Scan scan) {
+    // Compare the haversine term itself against the radius's, so misses
+    // skip the asin and sqrt
+    double half = std::sin(std::min(radius / EARTH_RADIUS_M, PI) / 2);
+    double limit = half * half;
+    double centerCos = std::cos(toRadians(center.lat));
+    GeoBox box = GeoBox::around(center, radius);
+    std::vector<std::pair<Item, double>> hits;
+    scan(box, [&](const Item& item, GeoPoint point) {
+        if (!box.contains(point)) return;
+        double dLat = std::sin(toRadians(point.lat - center.lat) / 2);
+        double dLon = std::sin(toRadians(point.lon - center.lon) / 2);
+        double h = dLat * dLat + centerCos * std::cos(toRadians(point.lat)) * dLon * dLon;
+        if (h <= limit) hits.emplace_back(item, 2 * EARTH_RADIUS_M * std::asin(std::min(1.0, std::sqrt(h))));
+    });
+    std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+    return hits;
+}
+
+// The k hits closest to the center, no farther than maxRadius. Searches a
+// radius that doubles from 1 km until it holds k hits: once it does, nothing
+// outside it can be closer than the k-th.
+template <typename Item, typename Scan>
+std::vector<std::pair<Item, double>> nearestK(GeoPoint center, size_t k, double maxRadius, Scan scan) {
+    constexpr double WHOLE_EARTH = PI * EARTH_RADIUS_M;
+    maxRadius = std::min(maxRadius, WHOLE_EARTH);
+    for (double radius = std::min(1000.0, maxRadius);; radius = std::min(radius * 2, maxRadius)) {
+        auto hits = withinRadius<Item>(center, radius, scan);
+        if (hits.size() >= k || radius >= maxRadius) {
+            if (hits.size() > k) hits.resize(k);
+            return hits;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "RoutingGraph.h"
+
+// Read-copy-update cell. Readers pin the current value with one atomic
+// shared_ptr load and never block; writers build a replacement off to the
+// side and publish it with an atomic swap. Replaced values are retired
+// rather than dropped, so the last reader never pays for freeing a large
+// object: each publish frees the retired values no reader pins any more.
+template <typename T>
+class RcuCell {
+public:
+    explicit RcuCell(std::shared_ptr<const T> initial) : current(std::move(initial)) {}
+
+    std::shared_ptr<const T> pin() const {
+        return std::atomic_load_explicit(&current, std::memory_order_acquire);
+    }
+
+    // Writers must be serialized by the caller
+    void publish(std::shared_ptr<const T> next) {
+        retired.push_back(std::atomic_exchange_explicit(&current, std::move(next),
+                                                        std::memory_order_acq_rel));
+        reclaim();
+    }
+
+    // Retired values still pinned by a reader
+    size_t retiredCount() const { return retired.size(); }
+
+private:
+    std::shared_ptr<const T> current;
+    std::vector<std::shared_ptr<const T>> retired;
+
+    // An unpublished value can only lose references, so a use count of one
+    // (ours) means no reader can still reach it
+    void reclaim() {
+        retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                     [](const auto& value) { return value.use_count() == 1; }),
+                      retired.end());
+    }
+};
+
+// Immutable routing graph plus the epoch it was published at. Queries pin
+// one snapshot for their whole run, so every index they use stays valid.
+struct GraphSnapshot {
+    RoutingGraph graph;
+    uint64_t epoch = 0;
+};
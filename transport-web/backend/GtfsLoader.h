@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "RoutingGraph.h"
+#include "StationIndex.h"
+
+// Stations and routes built from a GTFS feed
+struct GtfsNetwork {
+    std::vector<StationId> stationIds;
+    std::vector<std::string> stationNames;
+    std::vector<double> stationLats; // from stop_lat / stop_lon, NaN when blank;
+    std::vector<double> stationLons; // empty when stops.txt has no such columns
+    std::vector<RoutingGraph::Route> routes; // weight = fastest scheduled hop, minutes
+    size_t trips = 0;
+    size_t stopTimes = 0;   // stop_times rows used
+    size_t skippedRows = 0; // unknown trip or stop, or unparsable
+    size_t skippedStops = 0; // stops.txt rows without a name: generic nodes, boarding areas
+};
+
+// Loads stops.txt, trips.txt and stop_times.txt from a GTFS directory.
+// Files are memory-mapped and parsed in place (fields are views into the
+// mapping), so stop_times.txt is streamed rather than copied. It is split
+// into chunks at line boundaries and parsed in parallel; each chunk owns the
+// trips that start in it and reads past its end to finish the last one.
+// Like most feeds, rows of one trip are assumed contiguous; their
+// stop_sequence order is not.
+//
+// Numeric stop_ids keep their value as the station id; other stop_ids get
+// fresh ids above the largest numeric one.
+class GtfsLoader {
+public:
+    static GtfsNetwork load(const std::string& directory) {
+        GtfsNetwork network;
+        MappedFile stopsFile(directory + "/stops.txt");
+        MappedFile tripsFile(directory + "/trips.txt");
+        MappedFile stopTimesFile(directory + "/stop_times.txt");
+
+        std::unordered_map<std::string_view, uint32_t> stopIndex;
+        loadStops(stopsFile.view(), network, stopIndex);
+
+        std::unordered_set<std::string_view> tripIds;
+        forEachRow(tripsFile.view(), {"trip_id"}, [&](const Fields& row, const Columns& col) {
+            tripIds.insert(row[col[0]]);
+        });
+        network.trips = tripIds.size();
+
+        loadStopTimes(stopTimesFile.view(), stopIndex, tripIds, network);
+        return network;
+    }
+
+private:
+    using Fields = std::vector<std::string_view>;
+    using Columns = std::vector<size_t>;
+
+    static constexpr size_t CHUNK_BYTES = 8 << 20;
+
+    // One stop of one trip; times in seconds, -1 when not given
+    struct StopEvent {
+        uint32_t sequence;
+        uint32_t stop;
+        int32_t arrival;
+        int32_t departure;
+    };
+
+    struct ChunkResult {
+        std::unordered_map<uint64_t, uint32_t> hops; // stop pair -> fastest minutes
+        size_t rows = 0;
+        size_t skipped = 0;
+    };
+
+    // Split the line at `p` into `fields`; returns the start of the next line
+    static const char* splitRow(const char* p, const char* end, Fields& fields) {
+        fields.clear();
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+        const char* stop = lineEnd > p && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+        const char* cur = p;
+        for (;;) {
+            if (cur < stop && *cur == '"') {
+                const char* q = cur + 1;
+                while (q < stop && !(*q == '"' && (q + 1 >= stop || q[1] != '"'))) q += *q == '"' ? 2 : 1;
+                fields.emplace_back(cur + 1, std::min(q, stop) - (cur + 1));
+                cur = q;
+                while (cur < stop && *cur != ',') ++cur;
+            } else {
+                const char* comma = static_cast<const char*>(std::memchr(cur, ',', stop - cur));
+                if (!comma) comma = stop;
+                fields.emplace_back(cur, comma - cur);
+                cur = comma;
+            }
+            if (cur >= stop) break;
+            ++cur;
+        }
+        return lineEnd < end ? lineEnd + 1 : end;
+    }
+
+    // Parse the header, returning the first data row and the positions of
+    // the `wanted` columns
+    static const char* readHeader(std::string_view file, const std::vector<std::string_view>& wanted,
+                                  Columns& columns) {
+        const char* p = file.data();
+        const char* end = p + file.size();
+        if (file.size() >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+        Fields header;
+        p = splitRow(p, end, header);
+        columns.clear();
+        for (std::string_view name : wanted) {
+            size_t column = findColumn(header, name);
+            if (column == header.size()) throw std::runtime_error("GTFS file lacks column " + std::string(name));
+            columns.push_back(column);
+        }
+        return p;
+    }
+
+    static size_t findColumn(const Fields& header, std::string_view name) {
+        auto it = std::find_if(header.begin(), header.end(), [&](std::string_view h) {
+            while (!h.empty() && h.back() == ' ') h.remove_suffix(1);
+            return h == name;
+        });
+        return it - header.begin();
+    }
+
+    static bool hasColumns(std::string_view file, const std::vector<std::string_view>& names) {
+        if (file.size() >= 3 && std::memcmp(file.data(), "\xEF\xBB\xBF", 3) == 0) file.remove_prefix(3);
+        Fields header;
+        splitRow(file.data(), file.data() + file.size(), header);
+        return std::all_of(names.begin(), names.end(),
+                           [&](std::string_view name) { return findColumn(header, name) < header.size(); });
+    }
+
+    template <typename Fn>
+    static void forEachRow(std::string_view file, const std::vector<std::string_view>& wanted, Fn fn) {
+        Columns columns;
+        const char* p = readHeader(file, wanted, columns);
+        const char* end = file.data() + file.size();
+        size_t needed = *std::max_element(columns.begin(), columns.end()) + 1;
+        Fields row;
+        while (p < end) {
+            p = splitRow(p, end, row);
+            if (row.size() >= needed) fn(row, columns);
+        }
+    }
+
+    static bool parseInteger(std::string_view text, int64_t& out) {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+        return ec == std::errc() && ptr == text.data() + text.size() && !text.empty();
+    }
+
+    // NaN when blank or unparsable
+    static double parseCoordinate(std::string_view text) {
+        while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+        while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+        double value;
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc() && ptr == text.data() + text.size() && !text.empty() ? value : NAN;
+    }
+
+    // "H:MM:SS" or "HH:MM:SS", hours may pass 24; -1 when blank
+    static int32_t parseTime(std::string_view text) {
+        while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+        while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+        int32_t parts[3] = {0, 0, 0};
+        size_t part = 0;
+        for (char c : text) {
+            if (c == ':') {
+                if (++part > 2) return -1;
+            } else if (c >= '0' && c <= '9') {
+                parts[part] = parts[part] * 10 + (c - '0');
+            } else {
+                return -1;
+            }
+        }
+        return part == 2 ? parts[0] * 3600 + parts[1] * 60 + parts[2] : -1;
+    }
+
+    static std::string unescape(std::string_view field) {
+        std::string out(field);
+        for (size_t i = out.find("\"\""); i != std::string::npos; i = out.find("\"\"", i + 1)) out.erase(i, 1);
+        return out;
+    }
+
+    static void loadStops(std::string_view file, GtfsNetwork& network,
+                          std::unordered_map<std::string_view, uint32_t>& stopIndex) {
+        std::vector<std::string_view> keys;
+        bool located = hasColumns(file, {"stop_lat", "stop_lon"});
+        std::vector<std::string_view> wanted{"stop_id", "stop_name"};
+        if (located) wanted.insert(wanted.end(), {"stop_lat", "stop_lon"});
+        forEachRow(file, wanted, [&](const Fields& row, const Columns& col) {
+            std::string_view key = row[col[0]];
+            if (key.empty() || stopIndex.count(key)) return;
+            // stop_name is optional for nodes and boarding areas, which no
+            // trip stops at; they would only be nameless stations
+            if (row[col[1]].empty()) {
+                ++network.skippedStops;
+                return;
+            }
+            stopIndex.emplace(key, static_cast<uint32_t>(keys.size()));
+            keys.push_back(key);
+            network.stationNames.push_back(unescape(row[col[1]]));
+            if (!located) return;
+            double lat = parseCoordinate(row[col[2]]), lon = parseCoordinate(row[col[3]]);
+            bool valid = lat >= -90 && lat <= 90 && lon >= -180 && lon <= 180;
+            network.stationLats.push_back(valid ? lat : NAN);
+            network.stationLons.push_back(valid ? lon : NAN);
+        });
+
+        // Numeric ids first so they keep their value, then the rest above them
+        network.stationIds.assign(keys.size(), 0);
+        std::unordered_set<StationId> used;
+        StationId largest = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            int64_t value;
+            if (parseInteger(keys[i], value) && value > 0 && used.insert(value).second) {
+                network.stationIds[i] = value;
+                largest = std::max(largest, value);
+            }
+        }
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (network.stationIds[i] == 0) network.stationIds[i] = ++largest;
+        }
+    }
+
+    static void loadStopTimes(std::string_view file,
+                              const std::unordered_map<std::string_view, uint32_t>& stopIndex,
+                              const std::unordered_set<std::string_view>& tripIds, GtfsNetwork& network) {
+        Columns col;
+        const char* body = readHeader(file, {"trip_id", "arrival_time", "departure_time", "stop_id", "stop_sequence"}, col);
+        const char* end = file.data() + file.size();
+        const size_t needed = *std::max_element(col.begin(), col.end()) + 1;
+
+        // Chunk starts, each moved forward to a line start
+        std::vector<const char*> starts{body};
+        for (const char* p = body + CHUNK_BYTES; p < end; p += CHUNK_BYTES) {
+            const char* line = static_cast<const char*>(std::memchr(p - 1, '\n', end - (p - 1)));
+            if (!line || line + 1 >= end) break;
+            if (line + 1 > starts.back()) starts.push_back(line + 1);
+        }
+        starts.push_back(end);
+
+        std::vector<ChunkResult> results(starts.size() - 1);
+        parallelFor(results.size(), [&](size_t c) {
+            ChunkResult& result = results[c];
+            Fields row;
+            std::vector<StopEvent> trip;
+            std::string_view current;
+
+            // Trip running into this chunk from the previous one is not ours
+            std::string_view inherited;
+            if (c > 0) {
+                const char* prev = starts[c] - 1;
+                while (prev > body && prev[-1] != '\n') --prev;
+                splitRow(prev, starts[c], row);
+                if (row.size() >= needed) inherited = row[col[0]];
+            }
+
+            const char* p = starts[c];
+            bool leading = c > 0;
+            while (p < end) {
+                const char* next = splitRow(p, end, row);
+                if (row.size() < needed) {
+                    if (p < starts[c + 1]) ++result.skipped;
+                    p = next;
+                    continue;
+                }
+                std::string_view tripId = row[col[0]];
+                if (leading && tripId == inherited) { p = next; continue; }
+                leading = false;
+                if (tripId != current) {
+                    if (p >= starts[c + 1]) break; // past our end and the trip is done
+                    flushTrip(trip, result);
+                    current = tripId;
+                }
+                p = next;
+
+                auto stop = stopIndex.find(row[col[3]]);
+                int64_t sequence;
+                if (!tripIds.count(tripId) || stop == stopIndex.end() || !parseInteger(row[col[4]], sequence) || sequence < 0) {
+                    ++result.skipped;
+                    continue;
+                }
+                trip.push_back({static_cast<uint32_t>(sequence), stop->second,
+                                parseTime(row[col[1]]), parseTime(row[col[2]])});
+                ++result.rows;
+            }
+            flushTrip(trip, result);
+        });
+
+        std::unordered_map<uint64_t, uint32_t> hops;
+        for (ChunkResult& result : results) {
+            network.stopTimes += result.rows;
+            network.skippedRows += result.skipped;
+            for (const auto& [pair, minutes] : result.hops) {
+                auto [it, inserted] = hops.emplace(pair, minutes);
+                if (!inserted) it->second = std::min(it->second, minutes);
+            }
+            result.hops = {};
+        }
+        network.routes.reserve(hops.size());
+        for (const auto& [pair, minutes] : hops) {
+            network.routes.emplace_back(network.stationIds[pair >> 32], network.stationIds[uint32_t(pair)],
+                                        static_cast<int>(minutes));
+        }
+        std::sort(network.routes.begin(), network.routes.end());
+    }
+
+    // Turn one trip's stops into hops between consecutive stops. Stops
+    // without times get them interpolated from the timed stops around them.
+    static void flushTrip(std::vector<StopEvent>& trip, ChunkResult& result) {
+        std::sort(trip.begin(), trip.end(),
+                  [](const StopEvent& a, const StopEvent& b) { return a.sequence < b.sequence; });
+        for (StopEvent& event : trip) {
+            if (event.arrival < 0) event.arrival = event.departure;
+            if (event.departure < 0) event.departure = event.arrival;
+        }
+        size_t lastTimed = SIZE_MAX;
+        for (size_t i = 0; i < trip.size(); ++i) {
+            if (trip[i].arrival < 0) continue;
+            if (lastTimed != SIZE_MAX && i - lastTimed > 1) {
+                int32_t from = trip[lastTimed].departure;
+                int32_t span = trip[i].arrival - from;
+                for (size_t k = lastTimed + 1; k < i; ++k) {
+                    trip[k].arrival = trip[k].departure =
+                        from + static_cast<int32_t>(int64_t(span) * int64_t(k - lastTimed) / int64_t(i - lastTimed));
+                }
+            }
+            lastTimed = i;
+        }
+
+        for (size_t i = 0; i + 1 < trip.size(); ++i) {
+            const StopEvent& a = trip[i];
+            const StopEvent& b = trip[i + 1];
+            if (a.stop == b.stop || a.departure < 0 || b.arrival < 0) continue;
+            uint32_t minutes = static_cast<uint32_t>((std::max(0, b.arrival - a.departure) + 30) / 60);
+            uint64_t key = a.stop < b.stop ? (uint64_t(a.stop) << 32 | b.stop) : (uint64_t(b.stop) << 32 | a.stop);
+            auto [it, inserted] = result.hops.emplace(key, minutes);
+            if (!inserted) it->second = std::min(it->second, minutes);
+        }
+        trip.clear();
+    }
+};
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "PriorityQueue.h"
+#include "RoutingGraph.h"
+
+// Single-source shortest-path tree that is repaired in place when one
+// route changes (Ramalingam-Reps style) instead of being recomputed:
+//  - a cheaper or new route only improves distances, so the change is
+//    pushed outward from its endpoints with a Dijkstra over improved nodes;
+//  - a slower or removed route matters only if it is a tree edge; then just
+//    the subtree hanging below it is reset and re-attached from its
+//    unaffected neighbours.
+class ShortestPathTree {
+public:
+    ShortestPathTree(const RoutingGraph& graph, uint32_t source) : source(source) {
+        graph.oneToAll<RadixHeap>(source, dist, &parent);
+    }
+
+    uint32_t sourceNode() const { return source; }
+    uint32_t nodeCount() const { return static_cast<uint32_t>(dist.size()); }
+
+    RoutingGraph::PathResult pathTo(const RoutingGraph& graph, uint32_t target) const {
+        RoutingGraph::PathResult result;
+        if (target >= dist.size() || dist[target] == RoutingGraph::INF) return result;
+        result.found = true;
+        result.distance = dist[target];
+        for (uint32_t v = target; v != RoutingGraph::NONE; v = parent[v]) {
+            result.path.push_back(graph.stationAt(v));
+        }
+        std::reverse(result.path.begin(), result.path.end());
+        return result;
+    }
+
+    // The route {a, b} went from oldWeight to newWeight (INF = no route).
+    // `graph` must already reflect the new weight.
+    void edgeChanged(const RoutingGraph& graph, uint32_t a, uint32_t b,
+                     int64_t oldWeight, int64_t newWeight) {
+        if (newWeight < oldWeight) {
+            improve(graph, a, b, newWeight);
+        } else if (newWeight > oldWeight) {
+            uint32_t child = parent[b] == a ? b : (parent[a] == b ? a : RoutingGraph::NONE);
+            if (child != RoutingGraph::NONE) reattachSubtree(graph, child);
+        }
+    }
+
+private:
+    uint32_t source;
+    std::vector<int64_t> dist;
+    std::vector<uint32_t> parent;
+
+    void propagate(const RoutingGraph& graph, BinaryHeap& queue) {
+        while (!queue.empty()) {
+            auto [u, key] = queue.pop();
+            if (int64_t(key) > dist[u]) continue;
+            for (uint32_t e = graph.arcBegin(u); e < graph.arcEnd(u); ++e) {
+                uint32_t v = graph.arcTarget(e);
+                int64_t nd = dist[u] + graph.arcWeight(e);
+                if (nd < dist[v]) {
+                    dist[v] = nd;
+                    parent[v] = u;
+                    queue.push(v, nd);
+                }
+            }
+        }
+    }
+
+    void improve(const RoutingGraph& graph, uint32_t a, uint32_t b, int64_t weight) {
+        BinaryHeap queue;
+        for (auto [from, to] : {std::make_pair(a, b), std::make_pair(b, a)}) {
+            if (dist[from] == RoutingGraph::INF || dist[from] + weight >= dist[to]) continue;
+            dist[to] = dist[from] + weight;
+            parent[to] = from;
+            queue.push(to, dist[to]);
+        }
+        propagate(graph, queue);
+    }
+
+    void reattachSubtree(const RoutingGraph& graph, uint32_t child) {
+        // Collect the subtree below `child`; tree edges other than the changed
+        // one are still routes in the graph, so walking arcs finds them
+        std::vector<uint32_t> affected{child};
+        std::vector<char> inSubtree(dist.size(), 0);
+        inSubtree[child] = 1;
+        for (size_t i = 0; i < affected.size(); ++i) {
+            uint32_t u = affected[i];
+            for (uint32_t e = graph.arcBegin(u); e < graph.arcEnd(u); ++e) {
+                uint32_t v = graph.arcTarget(e);
+                if (!inSubtree[v] && parent[v] == u) {
+                    inSubtree[v] = 1;
+                    affected.push_back(v);
+                }
+            }
+        }
+        for (uint32_t v : affected) {
+            dist[v] = RoutingGraph::INF;
+            parent[v] = RoutingGraph::NONE;
+        }
+
+        // Seed each affected node with its best unaffected neighbour
+        BinaryHeap queue;
+        for (uint32_t v : affected) {
+            for (uint32_t e = graph.arcBegin(v); e < graph.arcEnd(v); ++e) {
+                uint32_t u = graph.arcTarget(e);
+                if (inSubtree[u] || dist[u] == RoutingGraph::INF) continue;
+                int64_t nd = dist[u] + graph.arcWeight(e);
+                if (nd < dist[v]) {
+                    dist[v] = nd;
+                    parent[v] = u;
+                }
+            }
+            if (dist[v] != RoutingGraph::INF) queue.push(v, dist[v]);
+        }
+        propagate(graph, queue);
+    }
+};
+
+// Shortest-path trees for the most frequently queried origins. An origin
+// gets a tree once it has been asked for `threshold` times; at most
+// `capacity` trees are kept, evicting the least recently used. Each tree is
+// tagged with the graph epoch it matches and is copied before a repair, so
+// readers holding an older graph snapshot keep a tree consistent with it.
+// Trees are built and repaired outside the lock and swapped in afterwards,
+// so a query never waits behind someone else's Dijkstra.
+class HotOriginTrees {
+public:
+    HotOriginTrees(size_t capacity, uint32_t threshold) : capacity(capacity), threshold(threshold) {}
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return trees.size();
+    }
+
+    // Count a query from `station` on the graph of `epoch` and return its
+    // tree if it is hot and matches that graph
+    std::shared_ptr<const ShortestPathTree> touch(const RoutingGraph& graph, uint64_t epoch, StationId station) {
+        uint32_t node = graph.indexOf(station);
+        if (node == RoutingGraph::NONE) return nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = trees.find(station);
+            if (it != trees.end()) {
+                Entry& entry = it->second;
+                recency.splice(recency.begin(), recency, entry.position);
+                if (entry.epoch > epoch) return nullptr; // reader is behind a repair
+                if (entry.epoch == epoch) return entry.tree;
+            } else if (++queryCounts[station] < threshold) {
+                return nullptr;
+            } else {
+                queryCounts.erase(station);
+            }
+        }
+
+        auto tree = std::make_shared<const ShortestPathTree>(graph, node);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = trees.find(station);
+        if (it == trees.end()) {
+            if (trees.size() >= capacity) {
+                trees.erase(recency.back());
+                recency.pop_back();
+            }
+            recency.push_front(station);
+            trees.emplace(station, Entry{tree, epoch, recency.begin()});
+        } else if (it->second.epoch < epoch) { // another query or a repair may have got there first
+            it->second.tree = tree;
+            it->second.epoch = epoch;
+        }
+        return tree;
+    }
+
+    // Carry every tree from `fromEpoch` to the graph of `toEpoch`, in which
+    // the route between two stations changed. Trees at other epochs, and all
+    // trees when a station is not in the graph, are left for touch() to
+    // rebuild when next asked for.
+    void edgeChanged(const RoutingGraph& graph, uint64_t fromEpoch, uint64_t toEpoch,
+                     StationId stationA, StationId stationB, int64_t oldWeight, int64_t newWeight) {
+        uint32_t a = graph.indexOf(stationA);
+        uint32_t b = graph.indexOf(stationB);
+        if (a == RoutingGraph::NONE || b == RoutingGraph::NONE) return;
+        std::vector<std::pair<StationId, std::shared_ptr<const ShortestPathTree>>> stale;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& [station, entry] : trees) {
+                if (entry.epoch == fromEpoch) stale.emplace_back(station, entry.tree);
+            }
+        }
+        for (auto& [station, tree] : stale) {
+            auto repaired = std::make_shared<ShortestPathTree>(*tree);
+            repaired->edgeChanged(graph, a, b, oldWeight, newWeight);
+            tree = std::move(repaired);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [station, tree] : stale) {
+            auto it = trees.find(station);
+            if (it == trees.end() || it->second.epoch != fromEpoch) continue;
+            it->second.tree = std::move(tree);
+            it->second.epoch = toEpoch;
+        }
+    }
+
+    // Station set changed: dense indices moved, so trees cannot be repaired
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        trees.clear();
+        recency.clear();
+        queryCounts.clear();
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const ShortestPathTree> tree;
+        uint64_t epoch = 0;
+        std::list<StationId>::iterator position;
+    };
+
+    size_t capacity;
+    uint32_t threshold;
+    std::mutex mutex;
+    std::unordered_map<StationId, Entry> trees;
+    std::list<StationId> recency; // most recently used first
+    std::unordered_map<StationId, uint32_t> queryCounts;
+};
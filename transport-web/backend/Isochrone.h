@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "DeltaStepping.h"
+#include "DialQueue.h"
+#include "PriorityQueue.h"
+#include "RoutingGraph.h"
+
+// Reachability within a travel budget. Route weights are small integers,
+// so the search runs on a Dial bucket queue instead of a binary heap; large
+// graphs on multi-core hosts use budget-capped delta-stepping instead.
+class Isochrone {
+public:
+    // Most buckets a Dial queue may use; past this a radix heap takes over
+    static constexpr uint32_t DIAL_LIMIT = 1 << 16;
+
+    // (node, distance) pairs for every node within `budget` of `source`, in
+    // nondecreasing distance order
+    static std::vector<std::pair<uint32_t, int64_t>> reachable(const RoutingGraph& graph,
+                                                               uint32_t source, int64_t budget) {
+        std::vector<std::pair<uint32_t, int64_t>> result;
+        if (source >= graph.nodeCount() || budget < 0) return result;
+
+        if (graph.nodeCount() >= DeltaStepping::PARALLEL_THRESHOLD && workerCount(graph.nodeCount()) > 1) {
+            std::vector<int64_t> dist;
+            DeltaStepping::run(graph, source, dist, budget);
+            for (uint32_t v = 0; v < graph.nodeCount(); ++v) {
+                if (dist[v] != RoutingGraph::INF) result.push_back({v, dist[v]});
+            }
+            std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+                return a.second != b.second ? a.second < b.second : a.first < b.first;
+            });
+            return result;
+        }
+
+        // Only arcs within the budget can be relaxed, so pending keys span at
+        // most min(heaviest arc, budget). A single huge arc must not size the
+        // bucket array.
+        uint64_t span = std::min<uint64_t>(graph.maxArcWeight(), uint64_t(budget));
+        if (span <= DIAL_LIMIT) {
+            DialQueue queue(static_cast<uint32_t>(span));
+            search(graph, source, budget, queue, result);
+        } else {
+            RadixHeap queue(graph.nodeCount());
+            search(graph, source, budget, queue, result);
+        }
+        return result;
+    }
+
+private:
+    template <typename Queue>
+    static void search(const RoutingGraph& graph, uint32_t source, int64_t budget, Queue& queue,
+                       std::vector<std::pair<uint32_t, int64_t>>& result) {
+        std::vector<int64_t> dist(graph.nodeCount(), RoutingGraph::INF);
+        dist[source] = 0;
+        queue.push(source, 0);
+        while (!queue.empty()) {
+            auto [u, d] = queue.pop();
+            if (int64_t(d) > dist[u]) continue; // stale entry
+            result.push_back({u, dist[u]});
+            for (uint32_t e = graph.arcBegin(u); e < graph.arcEnd(u); ++e) {
+                uint32_t v = graph.arcTarget(e);
+                int64_t nd = int64_t(d) + graph.arcWeight(e);
+                if (nd <= budget && nd < dist[v]) {
+                    dist[v] = nd;
+                    queue.push(v, nd);
+                }
+            }
+        }
+    }
+};
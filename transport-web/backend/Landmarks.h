@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DeltaStepping.h"
+#include "FlatArray.h"
+#include "RoutingGraph.h"
+
+// ALT routing: A* with landmark distances and the triangle inequality.
+// For every landmark L the distance d(L, v) to each node is stored, and
+// |d(L, t) - d(L, v)| is a lower bound on d(v, t). Raising a route weight
+// keeps those bounds admissible, so only weight decreases and structural
+// edits need a refresh (one Dijkstra per landmark).
+class LandmarkIndex {
+public:
+    using PathResult = RoutingGraph::PathResult;
+
+    enum class Selection { Farthest, Avoid };
+
+    static bool parseSelection(const std::string& name, Selection& out) {
+        if (name == "farthest") { out = Selection::Farthest; return true; }
+        if (name == "avoid") { out = Selection::Avoid; return true; }
+        return false;
+    }
+
+    static std::string selectionName(Selection selection) {
+        return selection == Selection::Farthest ? "farthest" : "avoid";
+    }
+
+    LandmarkIndex(uint32_t count, Selection selection) : count(count), selection(selection) {}
+
+    // Recompute distances for the current landmarks on `graph`, choosing new
+    // landmarks for any that no longer exist (or all of them on first use).
+    void refresh(const RoutingGraph& graph) {
+        std::vector<uint32_t> kept;
+        for (StationId station : stations) {
+            uint32_t node = graph.indexOf(station);
+            if (node != RoutingGraph::NONE) kept.push_back(node);
+        }
+        nodes.clear();
+        stations.clear();
+        dist = {};
+        n = graph.nodeCount();
+        for (uint32_t node : kept) addLandmark(graph, node);
+        selectRemaining(graph);
+    }
+
+    uint32_t landmarkCount() const { return static_cast<uint32_t>(nodes.size()); }
+    uint32_t targetCount() const { return count; }
+    const std::vector<StationId>& landmarkStations() const { return stations; }
+    Selection selectionMode() const { return selection; }
+
+    // A* from s to t (dense indices) guided by the landmark lower bounds
+    PathResult query(const RoutingGraph& graph, uint32_t s, uint32_t t) const {
+        PathResult result;
+        if (s >= n || t >= n || graph.nodeCount() != n) return result;
+
+        Scratch& sc = scratch();
+        sc.reset(n);
+        std::vector<int64_t> toTarget(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i) toTarget[i] = at(t, i);
+
+        using Entry = std::pair<int64_t, uint32_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+        sc.relax(s, 0, RoutingGraph::NONE);
+        pq.push({heuristic(s, toTarget), s});
+        while (!pq.empty()) {
+            uint32_t u = pq.top().second;
+            pq.pop();
+            if (sc.closed[u]) continue;
+            sc.closed[u] = 1;
+            if (u == t) break;
+            int64_t d = sc.dist[u];
+            for (uint32_t e = graph.arcBegin(u); e < graph.arcEnd(u); ++e) {
+                uint32_t v = graph.arcTarget(e);
+                int64_t nd = d + graph.arcWeight(e);
+                if (nd < sc.dist[v]) {
+                    sc.relax(v, nd, u);
+                    pq.push({nd + heuristic(v, toTarget), v});
+                }
+            }
+        }
+
+        if (sc.dist[t] == RoutingGraph::INF) return result;
+        result.found = true;
+        result.distance = sc.dist[t];
+        for (uint32_t v = t; v != RoutingGraph::NONE; v = sc.parent[v]) {
+            result.path.push_back(graph.stationAt(v));
+        }
+        std::reverse(result.path.begin(), result.path.end());
+        return result;
+    }
+
+private:
+    friend class NetworkSnapshot;
+
+    static constexpr uint32_t UNREACHABLE = RoutingGraph::NONE;
+
+    struct Scratch {
+        std::vector<int64_t> dist;
+        std::vector<uint32_t> parent;
+        std::vector<char> closed;
+        std::vector<uint32_t> touched;
+
+        void reset(uint32_t size) {
+            if (dist.size() != size) {
+                dist.assign(size, RoutingGraph::INF);
+                parent.assign(size, RoutingGraph::NONE);
+                closed.assign(size, 0);
+                touched.clear();
+                return;
+            }
+            for (uint32_t v : touched) {
+                dist[v] = RoutingGraph::INF;
+                parent[v] = RoutingGraph::NONE;
+                closed[v] = 0;
+            }
+            touched.clear();
+        }
+
+        void relax(uint32_t v, int64_t d, uint32_t from) {
+            if (dist[v] == RoutingGraph::INF) touched.push_back(v);
+            dist[v] = d;
+            parent[v] = from;
+        }
+    };
+
+    static Scratch& scratch() {
+        thread_local Scratch buffer;
+        return buffer;
+    }
+
+    uint32_t count;
+    Selection selection;
+    uint32_t n = 0;
+    std::vector<uint32_t> nodes;
+    std::vector<StationId> stations;
+    FlatArray<uint32_t> dist; // node-major: dist[v * landmarkCount() + i]
+
+    int64_t at(uint32_t v, size_t i) const {
+        uint32_t d = dist[size_t(v) * nodes.size() + i];
+        return d == UNREACHABLE ? RoutingGraph::INF : d;
+    }
+
+    int64_t heuristic(uint32_t v, const std::vector<int64_t>& toTarget) const {
+        int64_t best = 0;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            int64_t dv = at(v, i);
+            if (dv == RoutingGraph::INF || toTarget[i] == RoutingGraph::INF) continue;
+            best = std::max(best, dv > toTarget[i] ? dv - toTarget[i] : toTarget[i] - dv);
+        }
+        return best;
+    }
+
+    // Append a landmark and widen the node-major distance table
+    void addLandmark(const RoutingGraph& graph, uint32_t node) {
+        std::vector<int64_t> d;
+        DeltaStepping::run(graph, node, d);
+        const size_t k = nodes.size();
+        std::vector<uint32_t> widened(size_t(n) * (k + 1));
+        for (uint32_t v = 0; v < n; ++v) {
+            std::copy(dist.begin() + size_t(v) * k, dist.begin() + size_t(v) * k + k,
+                      widened.begin() + size_t(v) * (k + 1));
+            widened[size_t(v) * (k + 1) + k] =
+                d[v] >= UNREACHABLE ? UNREACHABLE : static_cast<uint32_t>(d[v]);
+        }
+        dist = std::move(widened);
+        nodes.push_back(node);
+        stations.push_back(graph.stationAt(node));
+    }
+
+    void selectRemaining(const RoutingGraph& graph) {
+        std::mt19937 rng(static_cast<uint32_t>(n) * 2654435761u);
+        while (nodes.size() < std::min<uint32_t>(count, n)) {
+            uint32_t next = nodes.empty() || selection == Selection::Farthest
+                ? farthestNode(graph, rng)
+                : avoidNode(graph, rng);
+            if (next == RoutingGraph::NONE ||
+                std::find(nodes.begin(), nodes.end(), next) != nodes.end()) break;
+            addLandmark(graph, next);
+        }
+    }
+
+    // Node farthest from the current landmark set; unreachable nodes win so
+    // that every component gets covered. Starts from a random node.
+    uint32_t farthestNode(const RoutingGraph& graph, std::mt19937& rng) const {
+        if (nodes.empty()) {
+            std::vector<int64_t> d;
+            DeltaStepping::run(graph, static_cast<uint32_t>(rng() % n), d);
+            return argmaxFinite(d);
+        }
+        uint32_t best = RoutingGraph::NONE;
+        int64_t bestDist = -1;
+        for (uint32_t v = 0; v < n; ++v) {
+            int64_t nearest = RoutingGraph::INF;
+            for (size_t i = 0; i < nodes.size(); ++i) nearest = std::min(nearest, at(v, i));
+            if (nearest > bestDist) { bestDist = nearest; best = v; }
+        }
+        return bestDist > 0 ? best : RoutingGraph::NONE;
+    }
+
+    static uint32_t argmaxFinite(const std::vector<int64_t>& d) {
+        uint32_t best = 0;
+        for (uint32_t v = 0; v < d.size(); ++v) {
+            if (d[v] != RoutingGraph::INF && d[v] > d[best]) best = v;
+        }
+        return best;
+    }
+
+    // Goldberg-Werneck "avoid": grow a shortest-path tree from a random root,
+    // weight each node by how badly the current landmarks bound its distance
+    // to the root, and descend into the heaviest landmark-free subtree.
+    uint32_t avoidNode(const RoutingGraph& graph, std::mt19937& rng) const {
+        uint32_t root = rng() % n;
+        std::vector<int64_t> d;
+        std::vector<uint32_t> parent, order;
+        graph.oneToAll(root, d, &parent, &order);
+
+        std::vector<int64_t> rootBound(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i) rootBound[i] = at(root, i);
+
+        std::vector<int64_t> size(n, 0);
+        std::vector<char> hasLandmark(n, 0);
+        for (uint32_t node : nodes) hasLandmark[node] = 1;
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            uint32_t v = *it;
+            if (hasLandmark[v]) size[v] = 0;
+            else size[v] += d[v] - heuristic(v, rootBound);
+            uint32_t p = parent[v];
+            if (p == RoutingGraph::NONE) continue;
+            if (hasLandmark[v]) hasLandmark[p] = 1;
+            else size[p] += size[v];
+        }
+
+        uint32_t best = RoutingGraph::NONE;
+        for (uint32_t v : order) {
+            if (size[v] > 0 && (best == RoutingGraph::NONE || size[v] > size[best])) best = v;
+        }
+        if (best == RoutingGraph::NONE) return farthestNode(graph, rng);
+
+        std::vector<std::vector<uint32_t>> children(n);
+        for (uint32_t v : order) {
+            if (parent[v] != RoutingGraph::NONE) children[parent[v]].push_back(v);
+        }
+        for (;;) {
+            uint32_t next = RoutingGraph::NONE;
+            for (uint32_t c : children[best]) {
+                if (size[c] > 0 && (next == RoutingGraph::NONE || size[c] > size[next])) next = c;
+            }
+            if (next == RoutingGraph::NONE) return best;
+            best = next;
+        }
+    }
+};
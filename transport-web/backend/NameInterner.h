@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Maps strings to dense 32-bit ids so records can carry a small integer
+// instead of a heap string. Interning goes through reader-writer locked
+// shards (repeated names only take a shared lock); resolving an id back to
+// its name takes no lock at all, since names live in fixed blocks that are
+// published once and never move.
+//
+// Ids are reference counted: every intern() is paired with a release(), and
+// a name whose last holder releases it frees its slot for reuse, so memory
+// follows the names in use rather than every name ever seen.
+class NameInterner {
+public:
+    NameInterner() : blocks(new std::atomic<std::string*>[MAX_BLOCKS]) {
+        for (size_t i = 0; i < MAX_BLOCKS; ++i) blocks[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~NameInterner() {
+        for (size_t i = 0; i < MAX_BLOCKS; ++i) delete[] blocks[i].load(std::memory_order_relaxed);
+    }
+
+    NameInterner(const NameInterner&) = delete;
+    NameInterner& operator=(const NameInterner&) = delete;
+
+    // Id for the name, holding one reference to it
+    uint32_t intern(std::string_view name) {
+        Shard& shard = shardOf(name);
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.ids.find(name);
+            if (it != shard.ids.end()) {
+                it->second.refs.fetch_add(1, std::memory_order_relaxed);
+                return it->second.id;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.ids.find(name);
+        if (it != shard.ids.end()) {
+            it->second.refs.fetch_add(1, std::memory_order_relaxed);
+            return it->second.id;
+        }
+        uint32_t id = allocate();
+        std::string& slot = slotFor(id);
+        slot.assign(name);
+        shard.ids.try_emplace(std::string_view(slot), id);
+        live.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    // Drop one reference taken by intern(); the id must not be resolved
+    // through this reference afterwards
+    void release(uint32_t id) {
+        std::string& slot = slotFor(id);
+        Shard& shard = shardOf(slot);
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.ids.find(slot);
+            if (it == shard.ids.end() || it->second.refs.fetch_sub(1, std::memory_order_relaxed) != 1) return;
+            shard.ids.erase(it);
+            std::string().swap(slot);
+        }
+        live.fetch_sub(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(freeMutex);
+        freeIds.push_back(id);
+    }
+
+    // Valid while the caller holds a reference to the id, from any thread
+    // that received it through a release/acquire hand-off (a queue, a mutex)
+    const std::string& name(uint32_t id) const {
+        return blocks[id / BLOCK_SIZE].load(std::memory_order_acquire)[id % BLOCK_SIZE];
+    }
+
+    // Distinct names currently referenced
+    size_t size() const { return live.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t SHARDS = 16;
+    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr size_t MAX_BLOCKS = 4096; // 16M names in use at once
+
+    struct Entry {
+        uint32_t id;
+        std::atomic<uint32_t> refs{1}; // bumped under the shard's shared lock
+
+        explicit Entry(uint32_t id) : id(id) {}
+    };
+
+    struct alignas(64) Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<std::string_view, Entry> ids; // keys view the blocks
+    };
+
+    Shard shards[SHARDS];
+    std::unique_ptr<std::atomic<std::string*>[]> blocks;
+    std::atomic<uint32_t> next{0};
+    std::atomic<size_t> live{0};
+    std::mutex freeMutex;
+    std::vector<uint32_t> freeIds; // released slots, reused before fresh ones
+
+    Shard& shardOf(std::string_view name) { return shards[std::hash<std::string_view>()(name) % SHARDS]; }
+
+    uint32_t allocate() {
+        {
+            std::lock_guard<std::mutex> lock(freeMutex);
+            if (!freeIds.empty()) {
+                uint32_t id = freeIds.back();
+                freeIds.pop_back();
+                return id;
+            }
+        }
+        uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+        if (id >= MAX_BLOCKS * BLOCK_SIZE) throw std::runtime_error("Name table is full");
+        return id;
+    }
+
+    // Blocks are allocated by whichever thread first needs one
+    std::string& slotFor(uint32_t id) {
+        std::atomic<std::string*>& block = blocks[id / BLOCK_SIZE];
+        std::string* current = block.load(std::memory_order_acquire);
+        if (!current) {
+            std::string* fresh = new std::string[BLOCK_SIZE];
+            if (block.compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) {
+                current = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        return current[id % BLOCK_SIZE];
+    }
+};
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ContractionHierarchy.h"
+#include "FlatArray.h"
+#include "GeoIndex.h"
+#include "Landmarks.h"
+#include "MappedFile.h"
+#include "RoutingGraph.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Binary network snapshot: the routing graph's arrays (station ids, the
+// dense id table, CSR offsets/targets/weights), station names as one string
+// pool, station coordinates when any are known, and the contraction
+// hierarchy and landmark tables when they are current. Loading maps the file
+// and points every array straight at it, so startup costs a few page faults
+// rather than a parse or a rebuild.
+//
+// Layout, native byte order:
+//   Header  { magic "ITNMSNAP", version, byteOrder, sectionCount, 0 }
+//   Section { tag, 0, offset, bytes } x sectionCount
+//   payloads, each starting on a 64-byte boundary
+// Section sizes are checked on load; contents are trusted, since only the
+// server writes these files. Sections are found by tag, so an optional one
+// is simply absent from the table. Version 2 added STATION_POSITIONS;
+// version 1 files still load, without coordinates.
+class NetworkSnapshot {
+public:
+    // Everything restored from a file. Arrays view the mapping, which stays
+    // alive as long as any of them does.
+    struct Contents {
+        RoutingGraph graph;
+        std::shared_ptr<const ContractionHierarchy> hierarchy; // null if not saved
+        std::shared_ptr<const LandmarkIndex> landmarks;        // null if not saved
+        FlatArray<uint64_t> nameOffsets;
+        FlatArray<char> namePool;
+        FlatArray<GeoPoint> positions; // by dense node, NaN where unknown; empty if not saved
+
+        std::string_view nameAt(uint32_t node) const {
+            return {namePool.data() + nameOffsets[node], size_t(nameOffsets[node + 1] - nameOffsets[node])};
+        }
+    };
+
+    // `names` and `positions` are indexed by dense node; an empty `positions`
+    // is not saved. The file is written next to `path` and renamed over it,
+    // so a crash never leaves a torn snapshot. Returns the file size.
+    static uint64_t write(const std::string& path, const RoutingGraph& graph, const std::vector<std::string>& names,
+                          const std::vector<GeoPoint>& positions, const ContractionHierarchy* hierarchy,
+                          const LandmarkIndex* landmarks) {
+        Meta meta{};
+        meta.maxWeight = graph.maxWeight;
+        std::vector<uint64_t> nameOffsets{0};
+        std::string pool;
+        for (const std::string& name : names) {
+            pool += name;
+            nameOffsets.push_back(pool.size());
+        }
+
+        std::vector<Section> sections;
+        std::vector<const void*> payloads;
+        auto add = [&](uint32_t tag, const void* data, uint64_t bytes) {
+            sections.push_back({tag, 0, 0, bytes});
+            payloads.push_back(data);
+        };
+        add(META, &meta, sizeof meta);
+        add(STATION_IDS, graph.stations.ids.data(), graph.stations.ids.size() * sizeof(StationId));
+        add(STATION_SLOTS, graph.stations.slots.data(), graph.stations.slots.size() * sizeof(uint32_t));
+        add(ARC_OFFSETS, graph.offsets.data(), graph.offsets.size() * sizeof(uint32_t));
+        add(ARC_TARGETS, graph.targets.data(), graph.targets.size() * sizeof(uint32_t));
+        add(ARC_WEIGHTS, graph.weights.data(), graph.weights.size() * sizeof(uint32_t));
+        add(NAME_OFFSETS, nameOffsets.data(), nameOffsets.size() * sizeof(uint64_t));
+        add(NAME_POOL, pool.data(), pool.size());
+        if (!positions.empty() && positions.size() == graph.nodeCount()) {
+            add(STATION_POSITIONS, positions.data(), positions.size() * sizeof(GeoPoint));
+        }
+        if (hierarchy && hierarchy->nodeCount() == graph.nodeCount()) {
+            meta.shortcuts = hierarchy->shortcuts;
+            add(CH_RANK, hierarchy->rank.data(), hierarchy->rank.size() * sizeof(uint32_t));
+            add(CH_UP_OFFSETS, hierarchy->upOffsets.data(), hierarchy->upOffsets.size() * sizeof(uint32_t));
+            add(CH_UP_ARCS, hierarchy->up.data(), hierarchy->up.size() * sizeof(ContractionHierarchy::UpArc));
+        }
+        if (landmarks && landmarks->n == graph.nodeCount()) {
+            meta.landmarkTarget = landmarks->count;
+            meta.landmarkSelection = static_cast<uint32_t>(landmarks->selection);
+            add(LANDMARK_NODES, landmarks->nodes.data(), landmarks->nodes.size() * sizeof(uint32_t));
+            add(LANDMARK_DIST, landmarks->dist.data(), landmarks->dist.size() * sizeof(uint32_t));
+        }
+
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof header.magic);
+        header.version = VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.sectionCount = static_cast<uint32_t>(sections.size());
+        uint64_t offset = align(sizeof header + sections.size() * sizeof(Section));
+        for (Section& section : sections) {
+            section.offset = offset;
+            offset = align(offset + section.bytes);
+        }
+
+        std::string temp = path + ".tmp";
+        std::FILE* file = std::fopen(temp.c_str(), "wb");
+        if (!file) throw std::runtime_error("Cannot create " + temp);
+        static const char padding[ALIGNMENT] = {};
+        uint64_t written = 0;
+        auto put = [&](const void* data, uint64_t bytes) {
+            if (written == UINT64_MAX) return;
+            written = bytes && std::fwrite(data, 1, bytes, file) != bytes ? UINT64_MAX : written + bytes;
+        };
+        put(&header, sizeof header);
+        put(sections.data(), sections.size() * sizeof(Section));
+        for (size_t i = 0; i < sections.size(); ++i) {
+            put(padding, sections[i].offset - written);
+            put(payloads[i], sections[i].bytes);
+        }
+        bool ok = written != UINT64_MAX && std::fflush(file) == 0 && syncFile(file);
+        ok = std::fclose(file) == 0 && ok;
+        if (!ok || !replaceFile(temp, path)) {
+            std::remove(temp.c_str());
+            throw std::runtime_error("Cannot write " + path);
+        }
+        // The rename is only durable once the directory is; callers truncate
+        // the log after this returns
+        if (!syncDirectoryOf(path)) throw std::runtime_error("Cannot sync the directory of " + path);
+        return written;
+    }
+
+    static Contents load(const std::string& path, uint64_t epoch) {
+        auto file = std::make_shared<const MappedFile>(path, false);
+        const char* base = file->data();
+        const uint64_t size = file->size();
+
+        Header header;
+        if (size < sizeof header) throw std::runtime_error(path + " is not a network snapshot");
+        std::memcpy(&header, base, sizeof header);
+        if (std::memcmp(header.magic, MAGIC, sizeof header.magic) != 0) {
+            throw std::runtime_error(path + " is not a network snapshot");
+        }
+        if (header.version < OLDEST_VERSION || header.version > VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+            throw std::runtime_error(path + " was written by an incompatible build");
+        }
+        if (sizeof header + uint64_t(header.sectionCount) * sizeof(Section) > size) {
+            throw std::runtime_error(path + " is truncated");
+        }
+        const Section* table = reinterpret_cast<const Section*>(base + sizeof header);
+        auto find = [&](uint32_t tag) -> const Section* {
+            for (uint32_t i = 0; i < header.sectionCount; ++i) {
+                const Section& section = table[i];
+                if (section.tag != tag) continue;
+                if (section.offset % ALIGNMENT || section.offset > size || section.bytes > size - section.offset) {
+                    throw std::runtime_error(path + " is truncated");
+                }
+                return &section;
+            }
+            return nullptr;
+        };
+        auto column = [&](uint32_t tag, auto type) {
+            using T = typename decltype(type)::type;
+            const Section* section = find(tag);
+            if (!section) throw std::runtime_error(path + " lacks a required section");
+            if (section->bytes % sizeof(T)) throw std::runtime_error(path + " is corrupt");
+            return FlatArray<T>::view(file, reinterpret_cast<const T*>(base + section->offset),
+                                      section->bytes / sizeof(T));
+        };
+        auto corrupt = [&](bool bad) {
+            if (bad) throw std::runtime_error(path + " is corrupt");
+        };
+
+        Meta meta;
+        const Section* metaSection = find(META);
+        corrupt(!metaSection || metaSection->bytes != sizeof meta);
+        std::memcpy(&meta, base + metaSection->offset, sizeof meta);
+
+        Contents contents;
+        RoutingGraph& graph = contents.graph;
+        graph.stations.ids = column(STATION_IDS, Type<StationId>{});
+        graph.stations.slots = column(STATION_SLOTS, Type<uint32_t>{});
+        graph.offsets = column(ARC_OFFSETS, Type<uint32_t>{});
+        graph.targets = column(ARC_TARGETS, Type<uint32_t>{});
+        graph.weights = column(ARC_WEIGHTS, Type<uint32_t>{});
+        graph.maxWeight = meta.maxWeight;
+        const size_t n = graph.stations.ids.size();
+        const size_t slots = graph.stations.slots.size();
+        corrupt(slots < n || (slots & (slots - 1)) != 0 || graph.offsets.size() != n + 1 ||
+                graph.targets.size() != graph.weights.size() || graph.offsets[n] != graph.targets.size());
+        graph.stations.mask = slots ? slots - 1 : 0;
+
+        contents.nameOffsets = column(NAME_OFFSETS, Type<uint64_t>{});
+        contents.namePool = column(NAME_POOL, Type<char>{});
+        corrupt(contents.nameOffsets.size() != n + 1 || contents.nameOffsets[n] != contents.namePool.size());
+
+        if (find(STATION_POSITIONS)) {
+            contents.positions = column(STATION_POSITIONS, Type<GeoPoint>{});
+            corrupt(contents.positions.size() != n);
+        }
+
+        if (find(CH_RANK)) {
+            auto hierarchy = std::shared_ptr<ContractionHierarchy>(new ContractionHierarchy(epoch));
+            hierarchy->ids = graph.stations.ids;
+            hierarchy->rank = column(CH_RANK, Type<uint32_t>{});
+            hierarchy->upOffsets = column(CH_UP_OFFSETS, Type<uint32_t>{});
+            hierarchy->up = column(CH_UP_ARCS, Type<ContractionHierarchy::UpArc>{});
+            hierarchy->shortcuts = meta.shortcuts;
+            corrupt(hierarchy->rank.size() != n || hierarchy->upOffsets.size() != n + 1 ||
+                    hierarchy->upOffsets[n] != hierarchy->up.size());
+            contents.hierarchy = hierarchy;
+        }
+
+        if (find(LANDMARK_NODES)) {
+            auto selection = static_cast<LandmarkIndex::Selection>(meta.landmarkSelection);
+            auto landmarks = std::make_shared<LandmarkIndex>(meta.landmarkTarget, selection);
+            FlatArray<uint32_t> nodes = column(LANDMARK_NODES, Type<uint32_t>{});
+            landmarks->n = static_cast<uint32_t>(n);
+            landmarks->nodes.assign(nodes.begin(), nodes.end());
+            for (uint32_t node : landmarks->nodes) {
+                corrupt(node >= n);
+                landmarks->stations.push_back(graph.stationAt(node));
+            }
+            landmarks->dist = column(LANDMARK_DIST, Type<uint32_t>{});
+            corrupt(landmarks->dist.size() != n * landmarks->nodes.size());
+            contents.landmarks = landmarks;
+        }
+        return contents;
+    }
+
+    // Routes of a restored graph, one per arc pair, for writers that rebuild
+    static std::vector<RoutingGraph::Route> routesOf(const RoutingGraph& graph) {
+        std::vector<RoutingGraph::Route> routes;
+        routes.reserve(graph.arcCount() / 2);
+        for (uint32_t u = 0; u < graph.nodeCount(); ++u) {
+            for (uint32_t e = graph.arcBegin(u); e < graph.arcEnd(u); ++e) {
+                uint32_t v = graph.arcTarget(e);
+                if (u < v) routes.emplace_back(graph.stationAt(u), graph.stationAt(v), graph.arcWeight(e));
+            }
+        }
+        return routes;
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'I', 'T', 'N', 'M', 'S', 'N', 'A', 'P'};
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t OLDEST_VERSION = 1; // still readable: later sections are optional
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr uint64_t ALIGNMENT = 64;
+
+    enum : uint32_t {
+        META = 1,
+        STATION_IDS,
+        STATION_SLOTS,
+        ARC_OFFSETS,
+        ARC_TARGETS,
+        ARC_WEIGHTS,
+        NAME_OFFSETS,
+        NAME_POOL,
+        CH_RANK,
+        CH_UP_OFFSETS,
+        CH_UP_ARCS,
+        LANDMARK_NODES,
+        LANDMARK_DIST,
+        STATION_POSITIONS
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t sectionCount;
+        uint32_t reserved;
+    };
+
+    struct Section {
+        uint32_t tag;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t bytes;
+    };
+
+    struct Meta {
+        uint32_t maxWeight;
+        uint32_t shortcuts;
+        uint32_t landmarkTarget;
+        uint32_t landmarkSelection;
+    };
+
+    template <typename T>
+    struct Type {
+        using type = T;
+    };
+
+    static uint64_t align(uint64_t offset) { return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    static bool syncFile(std::FILE* file) {
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return ::fsync(fileno(file)) == 0;
+#endif
+    }
+
+    static bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    // fsync the directory holding `path`, so a rename into it survives a
+    // crash. MOVEFILE_WRITE_THROUGH already covers this on Windows.
+    static bool syncDirectoryOf(const std::string& path) {
+#ifdef _WIN32
+        (void)path;
+        return true;
+#else
+        size_t slash = path.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+        int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd < 0) return false;
+        bool ok = ::fsync(fd) == 0;
+        return ::close(fd) == 0 && ok;
+#endif
+    }
+};
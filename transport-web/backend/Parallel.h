@@ -0,0 +1,29 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use for `items` independent work items
+inline unsigned workerCount(size_t items) {
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<unsigned>(std::min<size_t>(hw, std::max<size_t>(items, 1)));
+}
+
+// Run fn(i) for i in [0, count) across worker threads. Items are handed out
+// through a shared counter so uneven work balances itself. The calling
+// thread takes part, so a single worker runs inline.
+template <typename Fn>
+void parallelFor(size_t count, Fn fn, unsigned threads = 0) {
+    if (threads == 0) threads = workerCount(count);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) fn(i);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) thread.join();
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Boarding priority, highest first
+enum class PassengerClass : uint8_t { Accessibility = 0, Staff = 1, Regular = 2 };
+
+// Fixed-size queued passenger. The name is an id from a NameInterner (which
+// stays below 2^24, leaving room for the class in the same word).
+struct PassengerTicket {
+    static constexpr int64_t NO_DEADLINE = std::numeric_limits<int64_t>::max();
+
+    int32_t id;
+    uint32_t name;
+    PassengerClass priority = PassengerClass::Regular;
+    int64_t deadline = NO_DEADLINE; // unix seconds
+};
+
+// Bounded lock-free multi-producer/multi-consumer FIFO of passenger tickets
+// (Vyukov's ring). Each cell carries a sequence number that says whose turn
+// it is: producers claim a cell by advancing the tail with a CAS once the
+// cell is free for that lap, consumers likewise on the head, so a push or pop
+// is one CAS plus two cell accesses and nobody ever waits for a lock. A
+// ticket packs into two 64-bit words.
+class PassengerRing {
+public:
+    // Capacity is rounded up to a power of two
+    explicit PassengerRing(size_t capacity = 1 << 16) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // False when the ring is full
+    bool push(const PassengerTicket& ticket) {
+        size_t pos = tail.value.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t lag = intptr_t(sequence) - intptr_t(pos);
+            if (lag == 0) {
+                if (tail.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.head.store(packHead(ticket), std::memory_order_relaxed);
+                    cell.deadline.store(ticket.deadline, std::memory_order_relaxed);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false; // the cell still holds last lap's passenger
+            } else {
+                pos = tail.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Oldest ticket; false when the ring is empty
+    bool pop(PassengerTicket& out) {
+        size_t pos = head.value.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t lag = intptr_t(sequence) - intptr_t(pos + 1);
+            if (lag == 0) {
+                if (head.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = unpack(cell.head.load(std::memory_order_relaxed),
+                                 cell.deadline.load(std::memory_order_relaxed));
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                pos = head.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Approximate while producers or consumers are running
+    size_t size() const {
+        size_t h = head.value.load(std::memory_order_acquire);
+        size_t t = tail.value.load(std::memory_order_acquire);
+        return t > h ? t - h : 0;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    // Up to `limit` tickets from the front, oldest first, without removing
+    // them. Each cell is re-checked after it is read, so a ticket popped
+    // meanwhile is skipped rather than misread; exact when the ring is
+    // quiescent.
+    std::vector<PassengerTicket> peek(size_t limit) const {
+        std::vector<PassengerTicket> out;
+        size_t pos = head.value.load(std::memory_order_acquire);
+        size_t end = tail.value.load(std::memory_order_acquire);
+        for (; pos < end && out.size() < limit; ++pos) {
+            const Cell& cell = cells[pos & mask];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + 1) continue;
+            uint64_t head = cell.head.load(std::memory_order_relaxed);
+            int64_t deadline = cell.deadline.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (cell.sequence.load(std::memory_order_relaxed) != pos + 1) continue;
+            out.push_back(unpack(head, deadline));
+        }
+        return out;
+    }
+
+private:
+    struct alignas(64) Cursor {
+        std::atomic<size_t> value{0};
+    };
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        std::atomic<uint64_t> head{0}; // id, class, name
+        std::atomic<int64_t> deadline{0};
+    };
+
+    // Head and tail on their own cache lines so producers and consumers
+    // don't false-share
+    Cursor head;
+    Cursor tail;
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+
+    static uint64_t packHead(const PassengerTicket& ticket) {
+        return uint64_t(uint32_t(ticket.id)) << 32 | uint64_t(ticket.priority) << 24 | (ticket.name & 0xFFFFFF);
+    }
+
+    static PassengerTicket unpack(uint64_t head, int64_t deadline) {
+        return {static_cast<int32_t>(head >> 32), static_cast<uint32_t>(head & 0xFFFFFF),
+                static_cast<PassengerClass>((head >> 24) & 0xFF), deadline};
+    }
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "RoutingGraph.h"
+
+// Thread-safe fixed-capacity LRU map. Lookups promote the entry; inserts
+// evict the least recently used one once the cache is full.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity) : capacity(capacity) {}
+
+    bool get(const Key& key, Value& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            ++misses;
+            return false;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        out = it->second->second;
+        ++hits;
+        return true;
+    }
+
+    void put(const Key& key, Value value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+        if (capacity == 0) return;
+        if (entries.size() >= capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, std::move(value));
+        index[key] = entries.begin();
+    }
+
+    struct Stats {
+        size_t entries;
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return {entries.size(), hits, misses};
+    }
+
+private:
+    using Entry = std::pair<Key, Value>;
+
+    size_t capacity;
+    std::mutex mutex;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+// Shortest-path results are keyed by the graph epoch they were computed
+// on, so a mutation makes old entries unreachable without a flush; they
+// simply age out of the LRU.
+struct PathCacheKey {
+    StationId start;
+    StationId end;
+    std::string algorithm;
+    uint64_t epoch;
+
+    bool operator==(const PathCacheKey& other) const {
+        return start == other.start && end == other.end && epoch == other.epoch &&
+               algorithm == other.algorithm;
+    }
+};
+
+struct PathCacheKeyHash {
+    size_t operator()(const PathCacheKey& key) const {
+        uint64_t h = uint64_t(key.start) * 0xBF58476D1CE4E5B9ull ^ uint64_t(key.end);
+        h ^= key.epoch * 0x9E3779B97F4A7C15ull;
+        h ^= std::hash<std::string>()(key.algorithm) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        return static_cast<size_t>(h);
+    }
+};
+
+struct CachedPath {
+    RoutingGraph::PathResult result;
+    std::string algorithm; // algorithm that actually produced the result
+};
+
+using PathCache = LruCache<PathCacheKey, CachedPath, PathCacheKeyHash>;
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "NameInterner.h"
+#include "PassengerRing.h"
+
+// Passenger queue ordered by class (accessibility, then staff, then
+// regular), then earliest deadline, then arrival.
+//
+// Producers only touch the lock-free ring, so enqueueing never waits on a
+// consumer unless the ring fills up. Consumers take the lock, move whatever
+// has arrived in the ring into per-class buckets, and pop from there. Each
+// bucket is a binary heap on (deadline, arrival), and a bitmask of non-empty
+// buckets finds the highest class in one instruction, so a pop is O(log n)
+// in the size of that class alone.
+//
+// Names are interned while their passenger is queued and released when it
+// leaves, so the name table only holds names of passengers still waiting.
+class PriorityPassengerQueue {
+public:
+    static constexpr int64_t NO_DEADLINE = PassengerTicket::NO_DEADLINE;
+
+    struct Passenger {
+        int id;
+        std::string name;
+        PassengerClass priority;
+        int64_t deadline;
+    };
+
+    explicit PriorityPassengerQueue(size_t ingestCapacity = 1 << 16) : ingest(ingestCapacity) {}
+
+    void enqueue(int id, std::string_view name, PassengerClass priority = PassengerClass::Regular,
+                 int64_t deadline = NO_DEADLINE) {
+        PassengerTicket ticket{id, names.intern(name), priority, deadline};
+        // Ring full: nobody has dequeued in a while, so fold it in ourselves.
+        // The ticket still goes through the ring to keep arrivals in order.
+        while (!ingest.push(ticket)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            drain();
+        }
+    }
+
+    // Queue a whole group under one lock acquisition, skipping the ring.
+    // The group lands after everything that has reached the ring, in order.
+    void enqueueBatch(const std::vector<Passenger>& batch) {
+        std::vector<PassengerTicket> tickets;
+        tickets.reserve(batch.size());
+        try {
+            for (const Passenger& passenger : batch) {
+                tickets.push_back({passenger.id, names.intern(passenger.name), passenger.priority, passenger.deadline});
+            }
+        } catch (...) {
+            for (const PassengerTicket& ticket : tickets) names.release(ticket.name);
+            throw;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        drain();
+        for (const PassengerTicket& ticket : tickets) insert(ticket);
+    }
+
+    // Highest-priority passenger, or nothing when the queue is empty
+    std::optional<Passenger> dequeue() {
+        std::lock_guard<std::mutex> lock(mutex);
+        drain();
+        if (occupied == 0) return std::nullopt;
+        return take(popFront());
+    }
+
+    // Up to `count` passengers in priority order, under one lock acquisition
+    std::vector<Passenger> dequeueBatch(size_t count) {
+        std::vector<Entry> taken;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            drain();
+            while (occupied != 0 && taken.size() < count) taken.push_back(popFront());
+        }
+        std::vector<Passenger> out;
+        out.reserve(taken.size());
+        for (const Entry& entry : taken) out.push_back(take(entry));
+        return out;
+    }
+
+    // Up to `limit` passengers in the order they would be dequeued. Names
+    // are copied under the lock: once it drops, a dequeue may free them.
+    std::vector<Passenger> peek(size_t limit) {
+        std::vector<Entry> front;
+        std::lock_guard<std::mutex> lock(mutex);
+        drain();
+        for (int c = 0; c < CLASS_COUNT && front.size() < limit; ++c) {
+            const std::vector<Entry>& bucket = buckets[c];
+            size_t take = std::min(limit - front.size(), bucket.size());
+            size_t start = front.size();
+            front.insert(front.end(), bucket.begin(), bucket.end());
+            std::partial_sort(front.begin() + start, front.begin() + start + take, front.end(), earlier);
+            front.resize(start + take);
+        }
+        std::vector<Passenger> out;
+        out.reserve(front.size());
+        for (const Entry& entry : front) out.push_back(resolve(entry));
+        return out;
+    }
+
+    // Approximate while producers or consumers are running
+    size_t size() const { return queued.load(std::memory_order_relaxed) + ingest.size(); }
+
+    static const char* className(PassengerClass priority) {
+        switch (priority) {
+            case PassengerClass::Accessibility: return "accessibility";
+            case PassengerClass::Staff: return "staff";
+            default: return "regular";
+        }
+    }
+
+    // False for an unknown class name
+    static bool parseClass(const std::string& text, PassengerClass& out) {
+        if (text == "accessibility") out = PassengerClass::Accessibility;
+        else if (text == "staff") out = PassengerClass::Staff;
+        else if (text == "regular" || text.empty()) out = PassengerClass::Regular;
+        else return false;
+        return true;
+    }
+
+private:
+    static constexpr int CLASS_COUNT = 3;
+
+    struct Entry {
+        int64_t deadline;
+        uint64_t arrival;
+        int32_t id;
+        uint32_t name;
+        PassengerClass priority;
+    };
+
+    static bool earlier(const Entry& a, const Entry& b) {
+        return a.deadline != b.deadline ? a.deadline < b.deadline : a.arrival < b.arrival;
+    }
+    static bool later(const Entry& a, const Entry& b) { return earlier(b, a); }
+
+    NameInterner names;
+    PassengerRing ingest;
+
+    // Guarded by mutex
+    std::mutex mutex;
+    std::vector<Entry> buckets[CLASS_COUNT];
+    uint32_t occupied = 0; // bit c set while buckets[c] is non-empty
+    uint64_t arrivals = 0;
+    std::atomic<size_t> queued{0};
+
+    // Ring order is arrival order, so ties in a bucket stay FIFO
+    void drain() {
+        PassengerTicket ticket;
+        while (ingest.pop(ticket)) insert(ticket);
+    }
+
+    void insert(const PassengerTicket& ticket) {
+        int c = static_cast<int>(ticket.priority);
+        if (c >= CLASS_COUNT) c = CLASS_COUNT - 1;
+        std::vector<Entry>& bucket = buckets[c];
+        bucket.push_back({ticket.deadline, arrivals++, ticket.id, ticket.name, static_cast<PassengerClass>(c)});
+        std::push_heap(bucket.begin(), bucket.end(), later);
+        occupied |= 1u << c;
+        queued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Entry popFront() {
+        std::vector<Entry>& bucket = buckets[lowestBit(occupied)];
+        std::pop_heap(bucket.begin(), bucket.end(), later);
+        Entry entry = bucket.back();
+        bucket.pop_back();
+        if (bucket.empty()) occupied &= ~(1u << static_cast<int>(entry.priority));
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return entry;
+    }
+
+    Passenger resolve(const Entry& entry) const {
+        return {entry.id, names.name(entry.name), entry.priority, entry.deadline};
+    }
+
+    // Resolve an entry that has left the queue and drop its name reference
+    Passenger take(const Entry& entry) {
+        Passenger passenger = resolve(entry);
+        names.release(entry.name);
+        return passenger;
+    }
+
+    static int lowestBit(uint32_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctz(bits);
+#else
+        int bit = 0;
+        while (!(bits & 1u)) bits >>= 1, ++bit;
+        return bit;
+#endif
+    }
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Growable priority queues for Dijkstra-style searches over dense node
+// indices. All of them share one interface:
+//   Queue(nodeCount)           capacity hint; every queue still grows on demand
+//   push(node, key)            insert, or lower the key of a queued node
+//   pop() -> {node, key}       remove a minimum
+//   empty()
+// Lazy queues may hand back a node more than once; callers skip entries
+// whose key is larger than the node's settled distance.
+
+// std::priority_queue with lazy deletion; the baseline
+class BinaryHeap {
+public:
+    explicit BinaryHeap(uint32_t nodeCount = 0) { heap.reserve(nodeCount); }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    void push(uint32_t node, uint64_t key) {
+        heap.push_back({key, node});
+        std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+    }
+
+    std::pair<uint32_t, uint64_t> pop() {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        Entry top = heap.back();
+        heap.pop_back();
+        return {top.second, top.first};
+    }
+
+private:
+    using Entry = std::pair<uint64_t, uint32_t>;
+    std::vector<Entry> heap;
+};
+
+// Indexed 4-ary heap with true decrease-key: each node is queued at most
+// once. Four children per node halve the tree height and keep siblings in
+// one cache line, which pays off on the sift-down heavy pop.
+class QuaternaryHeap {
+public:
+    explicit QuaternaryHeap(uint32_t nodeCount = 0) : position(nodeCount, ABSENT) {
+        heap.reserve(nodeCount);
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    bool contains(uint32_t node) const { return node < position.size() && position[node] != ABSENT; }
+
+    void push(uint32_t node, uint64_t key) {
+        if (node >= position.size()) position.resize(size_t(node) + 1, ABSENT);
+        uint32_t slot = position[node];
+        if (slot == ABSENT) {
+            slot = static_cast<uint32_t>(heap.size());
+            heap.push_back({key, node});
+            position[node] = slot;
+        } else if (key < heap[slot].key) {
+            heap[slot].key = key;
+        } else {
+            return;
+        }
+        siftUp(slot);
+    }
+
+    std::pair<uint32_t, uint64_t> pop() {
+        Entry top = heap.front();
+        position[top.node] = ABSENT;
+        Entry last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            position[last.node] = 0;
+            siftDown(0);
+        }
+        return {top.node, top.key};
+    }
+
+private:
+    static constexpr uint32_t ABSENT = std::numeric_limits<uint32_t>::max();
+
+    struct Entry {
+        uint64_t key;
+        uint32_t node;
+    };
+
+    std::vector<Entry> heap;
+    std::vector<uint32_t> position; // node -> heap slot
+
+    void place(uint32_t slot, const Entry& entry) {
+        heap[slot] = entry;
+        position[entry.node] = slot;
+    }
+
+    void siftUp(uint32_t slot) {
+        Entry moving = heap[slot];
+        while (slot > 0) {
+            uint32_t parent = (slot - 1) / 4;
+            if (heap[parent].key <= moving.key) break;
+            place(slot, heap[parent]);
+            slot = parent;
+        }
+        place(slot, moving);
+    }
+
+    void siftDown(uint32_t slot) {
+        Entry moving = heap[slot];
+        const size_t n = heap.size();
+        for (;;) {
+            size_t first = size_t(slot) * 4 + 1;
+            if (first >= n) break;
+            size_t best = first;
+            size_t last = std::min(first + 4, n);
+            for (size_t c = first + 1; c < last; ++c) {
+                if (heap[c].key < heap[best].key) best = c;
+            }
+            if (heap[best].key >= moving.key) break;
+            place(slot, heap[best]);
+            slot = static_cast<uint32_t>(best);
+        }
+        place(slot, moving);
+    }
+};
+
+// Monotone radix heap (Ahuja et al.): keys popped never decrease, so an entry
+// lives in the bucket given by the highest bit in which its key differs from
+// the last popped key. Each entry moves to a lower bucket at most 64 times,
+// and pushes are O(1). Lazy, like BinaryHeap.
+class RadixHeap {
+public:
+    explicit RadixHeap(uint32_t nodeCount = 0) { buckets[0].reserve(nodeCount / 8); }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    // `key` must not be smaller than the last popped key
+    void push(uint32_t node, uint64_t key) {
+        buckets[bucketOf(key)].push_back({key, node});
+        ++count;
+    }
+
+    std::pair<uint32_t, uint64_t> pop() {
+        if (buckets[0].empty()) {
+            size_t b = 1;
+            while (buckets[b].empty()) ++b;
+            // Redistribute the first non-empty bucket around its minimum
+            uint64_t minKey = buckets[b][0].key;
+            for (const Entry& entry : buckets[b]) minKey = std::min(minKey, entry.key);
+            last = minKey;
+            for (const Entry& entry : buckets[b]) buckets[bucketOf(entry.key)].push_back(entry);
+            buckets[b].clear();
+        }
+        Entry top = buckets[0].back();
+        buckets[0].pop_back();
+        --count;
+        return {top.node, top.key};
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t node;
+    };
+
+    std::vector<Entry> buckets[65];
+    uint64_t last = 0;
+    size_t count = 0;
+
+    size_t bucketOf(uint64_t key) const { return bitWidth(key ^ last); }
+
+    // Bits needed to hold `value`: 0 for 0, else one past the highest set bit
+    static size_t bitWidth(uint64_t value) {
+        if (value == 0) return 0;
+#if defined(__GNUC__) || defined(__clang__)
+        return 64 - static_cast<size_t>(__builtin_clzll(value));
+#else
+        size_t width = 0;
+        while (value) value >>= 1, ++width;
+        return width;
+#endif
+    }
+};
+
+// Queue kinds selectable per query
+enum class QueueKind { Binary, Quaternary, Radix };
+
+inline bool parseQueueKind(const std::string& name, QueueKind& out) {
+    if (name == "binary") { out = QueueKind::Binary; return true; }
+    if (name == "quaternary" || name == "4ary") { out = QueueKind::Quaternary; return true; }
+    if (name == "radix") { out = QueueKind::Radix; return true; }
+    return false;
+}
+
+inline std::string queueKindName(QueueKind kind) {
+    switch (kind) {
+        case QueueKind::Quaternary: return "quaternary";
+        case QueueKind::Radix: return "radix";
+        default: return "binary";
+    }
+}
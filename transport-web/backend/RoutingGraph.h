@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "FlatArray.h"
+#include "PriorityQueue.h"
+#include "StationIndex.h"
+
+// Compressed-sparse-row adjacency store for the routing graph.
+// Stations are mapped to dense indices 0..n-1 and every route is stored as
+// two arcs (routes are bidirectional links between stations). The arcs of
+// node u live in targets/weights[offsets[u] .. offsets[u + 1]).
+class RoutingGraph {
+public:
+    static constexpr int64_t INF = std::numeric_limits<int64_t>::max();
+    static constexpr uint32_t NONE = StationIndex::NONE;
+
+    using Route = std::tuple<StationId, StationId, int>; // source, dest, weight
+
+    struct PathResult {
+        bool found = false;
+        int64_t distance = INF;
+        std::vector<StationId> path; // station ids, start first
+    };
+
+    RoutingGraph() : offsets(std::vector<uint32_t>(1, 0)) {}
+
+    // Rebuild the whole store. Every route must join two different known
+    // stations with a non-negative weight; callers validate input first, so
+    // a bad route throws std::invalid_argument rather than vanish.
+    void build(const std::vector<StationId>& stationIds, const std::vector<Route>& routes) {
+        stations.assign(stationIds);
+
+        const uint32_t n = stations.size();
+        std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> arcs;
+        arcs.reserve(routes.size() * 2);
+        for (const auto& route : routes) {
+            uint32_t u = indexOf(std::get<0>(route));
+            uint32_t v = indexOf(std::get<1>(route));
+            int w = std::get<2>(route);
+            if (u == NONE || v == NONE || u == v || w < 0) {
+                throw std::invalid_argument("Invalid route " + std::to_string(std::get<0>(route)) + " -> " +
+                                            std::to_string(std::get<1>(route)));
+            }
+            arcs.emplace_back(u, v, static_cast<uint32_t>(w));
+            arcs.emplace_back(v, u, static_cast<uint32_t>(w));
+        }
+
+        // Counting sort by tail node
+        std::vector<uint32_t> first(n + 1, 0);
+        for (const auto& arc : arcs) {
+            ++first[std::get<0>(arc) + 1];
+        }
+        for (uint32_t i = 0; i < n; ++i) {
+            first[i + 1] += first[i];
+        }
+        std::vector<uint32_t> heads(arcs.size(), 0);
+        std::vector<uint32_t> costs(arcs.size(), 0);
+        maxWeight = 0;
+        std::vector<uint32_t> cursor(first.begin(), first.end() - 1);
+        for (const auto& arc : arcs) {
+            uint32_t slot = cursor[std::get<0>(arc)]++;
+            heads[slot] = std::get<1>(arc);
+            costs[slot] = std::get<2>(arc);
+            maxWeight = std::max(maxWeight, std::get<2>(arc));
+        }
+        offsets = std::move(first);
+        targets = std::move(heads);
+        weights = std::move(costs);
+    }
+
+    // Update the weight of an existing route in place. Returns false when the
+    // route is not in the store and a rebuild is needed instead.
+    bool patchWeight(StationId source, StationId dest, int weight) {
+        uint32_t u = indexOf(source);
+        uint32_t v = indexOf(dest);
+        if (u == NONE || v == NONE || weight < 0) return false;
+        bool patched = false;
+        uint32_t* cost = nullptr; // copied out of a mapped snapshot on first patch
+        for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            if (targets[e] != v) continue;
+            if (!cost) cost = weights.mutableData();
+            cost[e] = static_cast<uint32_t>(weight);
+            patched = true;
+        }
+        for (uint32_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+            if (targets[e] != u) continue;
+            if (!cost) cost = weights.mutableData();
+            cost[e] = static_cast<uint32_t>(weight);
+            patched = true;
+        }
+        if (patched) maxWeight = std::max(maxWeight, static_cast<uint32_t>(weight));
+        return patched;
+    }
+
+    uint32_t indexOf(StationId stationId) const { return stations.indexOf(stationId); }
+    StationId stationAt(uint32_t node) const { return stations.idAt(node); }
+    uint32_t nodeCount() const { return stations.size(); }
+    uint32_t arcCount() const { return static_cast<uint32_t>(targets.size()); }
+
+    uint32_t arcBegin(uint32_t node) const { return offsets[node]; }
+    uint32_t arcEnd(uint32_t node) const { return offsets[node + 1]; }
+    uint32_t arcTarget(uint32_t arc) const { return targets[arc]; }
+    uint32_t arcWeight(uint32_t arc) const { return weights[arc]; }
+    // Upper bound on arc weights (patches never lower it)
+    uint32_t maxArcWeight() const { return maxWeight; }
+
+    // Point-to-point Dijkstra with early exit once the target is settled.
+    // `Queue` is any queue from PriorityQueue.h.
+    template <typename Queue = BinaryHeap>
+    PathResult dijkstra(StationId start, StationId end) const {
+        PathResult result;
+        uint32_t s = indexOf(start);
+        uint32_t t = indexOf(end);
+        if (s == NONE || t == NONE) return result;
+
+        std::vector<int64_t> dist(nodeCount(), INF);
+        std::vector<uint32_t> parent(nodeCount(), NONE);
+        Queue pq(nodeCount());
+
+        dist[s] = 0;
+        pq.push(s, 0);
+        while (!pq.empty()) {
+            auto [u, key] = pq.pop();
+            int64_t d = static_cast<int64_t>(key);
+            if (d > dist[u]) continue; // stale entry
+            if (u == t) break;
+            for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                uint32_t v = targets[e];
+                int64_t nd = d + weights[e];
+                if (nd < dist[v]) {
+                    dist[v] = nd;
+                    parent[v] = u;
+                    pq.push(v, nd);
+                }
+            }
+        }
+
+        if (dist[t] == INF) return result;
+        result.found = true;
+        result.distance = dist[t];
+        for (uint32_t v = t; v != NONE; v = parent[v]) {
+            result.path.push_back(stations.idAt(v));
+        }
+        std::reverse(result.path.begin(), result.path.end());
+        return result;
+    }
+
+    PathResult dijkstra(StationId start, StationId end, QueueKind queue) const {
+        switch (queue) {
+            case QueueKind::Quaternary: return dijkstra<QuaternaryHeap>(start, end);
+            case QueueKind::Radix: return dijkstra<RadixHeap>(start, end);
+            default: return dijkstra<BinaryHeap>(start, end);
+        }
+    }
+
+    // Full Dijkstra from a dense node index. `order` (optional) receives the
+    // nodes in settle order and `parent` the shortest-path tree.
+    template <typename Queue = BinaryHeap>
+    void oneToAll(uint32_t source, std::vector<int64_t>& dist,
+                  std::vector<uint32_t>* parent = nullptr,
+                  std::vector<uint32_t>* order = nullptr) const {
+        dist.assign(nodeCount(), INF);
+        if (parent) parent->assign(nodeCount(), NONE);
+        if (order) order->clear();
+        if (source >= nodeCount()) return;
+
+        Queue pq(nodeCount());
+        dist[source] = 0;
+        pq.push(source, 0);
+        while (!pq.empty()) {
+            auto [u, key] = pq.pop();
+            int64_t d = static_cast<int64_t>(key);
+            if (d > dist[u]) continue;
+            if (order) order->push_back(u);
+            for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                uint32_t v = targets[e];
+                int64_t nd = d + weights[e];
+                if (nd < dist[v]) {
+                    dist[v] = nd;
+                    if (parent) (*parent)[v] = u;
+                    pq.push(v, nd);
+                }
+            }
+        }
+    }
+
+private:
+    friend class NetworkSnapshot;
+
+    StationIndex stations;
+    FlatArray<uint32_t> offsets;
+    FlatArray<uint32_t> targets;
+    FlatArray<uint32_t> weights;
+    uint32_t maxWeight = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Hash map split into independently locked shards. Each shard has its own
+// reader-writer lock, so lookups on any shard run concurrently and writers
+// only block the one shard their key falls in. Shards are padded to a
+// cache line so neighbouring locks don't false-share.
+template <typename Key, typename Value, size_t Shards = 16, typename Hash = std::hash<Key>>
+class ShardedMap {
+public:
+    // Insert or overwrite; true when the key was new
+    bool insertOrAssign(const Key& key, Value value) {
+        Shard& shard = shardOf(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto [it, inserted] = shard.items.insert_or_assign(key, std::move(value));
+        if (inserted) count.fetch_add(1, std::memory_order_relaxed);
+        return inserted;
+    }
+
+    // Modify an existing value in place; false when the key is absent
+    template <typename Fn>
+    bool update(const Key& key, Fn fn) {
+        Shard& shard = shardOf(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.items.find(key);
+        if (it == shard.items.end()) return false;
+        fn(it->second);
+        return true;
+    }
+
+    bool erase(const Key& key) {
+        Shard& shard = shardOf(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (!shard.items.erase(key)) return false;
+        count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool get(const Key& key, Value& out) const {
+        const Shard& shard = shardOf(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.items.find(key);
+        if (it == shard.items.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+    bool contains(const Key& key) const {
+        const Shard& shard = shardOf(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.items.count(key) != 0;
+    }
+
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    // All entries sorted by key. Shards are copied one at a time, so the
+    // result is consistent per shard, not across the whole map.
+    std::vector<std::pair<Key, Value>> snapshot() const {
+        std::vector<std::pair<Key, Value>> all;
+        all.reserve(size());
+        for (const Shard& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            all.insert(all.end(), shard.items.begin(), shard.items.end());
+        }
+        std::sort(all.begin(), all.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        return all;
+    }
+
+private:
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, Value, Hash> items;
+    };
+
+    std::array<Shard, Shards> shards;
+    std::atomic<size_t> count{0};
+
+    // Fibonacci hashing on top of Hash, since std::hash<int> is the identity
+    // and sequential ids would otherwise stripe poorly
+    size_t shardIndex(const Key& key) const {
+        uint64_t h = static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h >> 32) % Shards;
+    }
+
+    Shard& shardOf(const Key& key) { return shards[shardIndex(key)]; }
+    const Shard& shardOf(const Key& key) const { return shards[shardIndex(key)]; }
+};
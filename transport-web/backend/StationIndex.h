@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "FlatArray.h"
+
+// External station ids are bigint in the database and set by hand, so they
+// can be sparse and exceed INT_MAX
+using StationId = int64_t;
+
+// Translates external station ids to dense 32-bit indices 0..n-1, so every
+// per-node array (distances, parents, bitmaps) is contiguous and inner loops
+// never touch the id space. Lookups go through an open-addressing table
+// (linear probing, at most half full) whose slots hold only the dense index;
+// the id itself is compared against the dense id array.
+class StationIndex {
+public:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    // Index i is assigned to stationIds[i]; ids must be unique
+    void assign(const std::vector<StationId>& stationIds) {
+        size_t capacity = 16;
+        while (capacity < stationIds.size() * 2) capacity <<= 1;
+        std::vector<uint32_t> table(capacity, NONE);
+        mask = capacity - 1;
+        for (uint32_t i = 0; i < stationIds.size(); ++i) {
+            size_t slot = hash(stationIds[i]) & mask;
+            while (table[slot] != NONE) slot = (slot + 1) & mask;
+            table[slot] = i;
+        }
+        ids = stationIds;
+        slots = std::move(table);
+    }
+
+    uint32_t indexOf(StationId id) const {
+        if (slots.empty()) return NONE;
+        for (size_t slot = hash(id) & mask;; slot = (slot + 1) & mask) {
+            uint32_t i = slots[slot];
+            if (i == NONE || ids[i] == id) return i;
+        }
+    }
+
+    StationId idAt(uint32_t index) const { return ids[index]; }
+    uint32_t size() const { return static_cast<uint32_t>(ids.size()); }
+
+private:
+    friend class NetworkSnapshot;
+
+    FlatArray<StationId> ids; // dense index -> station id
+    FlatArray<uint32_t> slots; // hash slot -> dense index
+    size_t mask = 0;
+
+    // splitmix64 finalizer; hand-assigned ids are often sequential
+    static size_t hash(StationId id) {
+        uint64_t x = static_cast<uint64_t>(id);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<size_t>(x ^ (x >> 31));
+    }
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SWISS_TABLE_SSE2 1
+#endif
+
+// Open-addressing map from int32 keys to small values, laid out like a
+// Swiss table: one control byte per slot holding 7 bits of the hash (or
+// EMPTY), scanned a group at a time so a lookup compares 16 slots with a
+// couple of SSE2 instructions and only touches a slot whose byte matches.
+//
+// Probing is linear from the key's home slot, which lets erase shift the
+// rest of the run back into the hole instead of leaving a tombstone; runs
+// never contain gaps, so a group with an empty byte ends every search. The
+// control array repeats its first GROUP - 1 bytes past the end so a group
+// read never has to wrap.
+//
+// Not thread-safe; see VehicleTable for the shared version.
+template <typename Value>
+class SwissTable {
+public:
+    SwissTable() { allocate(MIN_CAPACITY); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Null when absent. Valid until the next insert or erase.
+    Value* find(int32_t key) {
+        size_t slot = locate(key);
+        return slot == NONE ? nullptr : &slots[slot].value;
+    }
+    const Value* find(int32_t key) const {
+        size_t slot = locate(key);
+        return slot == NONE ? nullptr : &slots[slot].value;
+    }
+
+    // Insert or overwrite; true when the key was new
+    bool insertOrAssign(int32_t key, Value value) {
+        size_t slot = locate(key);
+        if (slot != NONE) {
+            slots[slot].value = std::move(value);
+            return false;
+        }
+        if ((count + 1) * 8 > capacity() * 7) allocate(capacity() * 2);
+        place(key, std::move(value));
+        ++count;
+        return true;
+    }
+
+    bool erase(int32_t key) {
+        size_t hole = locate(key);
+        if (hole == NONE) return false;
+        // Backward shift: pull later members of the run into the hole as
+        // long as that doesn't move them before their home slot
+        size_t mask = capacity() - 1;
+        for (size_t next = (hole + 1) & mask; control[next] != EMPTY; next = (next + 1) & mask) {
+            size_t home = hash(slots[next].key) >> 7 & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = std::move(slots[next]);
+                setControl(hole, control[next]);
+                hole = next;
+            }
+        }
+        setControl(hole, EMPTY);
+        --count;
+        return true;
+    }
+
+    // fn(key, value) for every entry, in table order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (size_t i = 0; i < capacity(); ++i) {
+            if (control[i] != EMPTY) fn(slots[i].key, slots[i].value);
+        }
+    }
+
+    // Keeps the capacity, for tables that are refilled in rounds
+    void clear() {
+        std::fill(control.begin(), control.end(), EMPTY);
+        count = 0;
+    }
+
+private:
+#ifdef SWISS_TABLE_SSE2
+    static constexpr size_t GROUP = 16;
+#else
+    static constexpr size_t GROUP = 8;
+#endif
+    static constexpr size_t MIN_CAPACITY = 16;
+    static constexpr size_t NONE = ~size_t(0);
+    static constexpr uint8_t EMPTY = 0x80;
+
+    struct Slot {
+        int32_t key;
+        Value value;
+    };
+
+    std::vector<uint8_t> control; // capacity + GROUP - 1 bytes
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    size_t capacity() const { return slots.size(); }
+
+    // Murmur3 finalizer: low 7 bits go to the control byte, the rest pick
+    // the home slot
+    static uint64_t hash(int32_t key) {
+        uint64_t h = static_cast<uint32_t>(key);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        return h ^ (h >> 33);
+    }
+
+    // Bit i set when byte i of the group starting at `at` equals h2 / is empty
+#ifdef SWISS_TABLE_SSE2
+    uint32_t matchByte(size_t at, uint8_t h2) const {
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control.data() + at));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(h2)))));
+    }
+    uint32_t matchEmpty(size_t at) const {
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control.data() + at));
+        return static_cast<uint32_t>(_mm_movemask_epi8(group));
+    }
+#else
+    // SWAR fallback over 8 bytes; the zero-byte trick can flag a byte after
+    // a real match, which the key comparison then rejects
+    uint32_t matchByte(size_t at, uint8_t h2) const {
+        uint64_t word;
+        std::memcpy(&word, control.data() + at, sizeof word);
+        uint64_t x = word ^ (0x0101010101010101ull * h2);
+        return compress((x - 0x0101010101010101ull) & ~x & 0x8080808080808080ull);
+    }
+    uint32_t matchEmpty(size_t at) const {
+        uint64_t word;
+        std::memcpy(&word, control.data() + at, sizeof word);
+        return compress(word & 0x8080808080808080ull);
+    }
+    static uint32_t compress(uint64_t highBits) {
+        uint32_t bits = 0;
+        for (int i = 0; i < 8; ++i) bits |= static_cast<uint32_t>(highBits >> (8 * i + 7) & 1) << i;
+        return bits;
+    }
+#endif
+
+    static int lowestBit(uint32_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctz(bits);
+#else
+        int bit = 0;
+        while (!(bits & 1u)) bits >>= 1, ++bit;
+        return bit;
+#endif
+    }
+
+    size_t locate(int32_t key) const {
+        uint64_t h = hash(key);
+        uint8_t h2 = static_cast<uint8_t>(h & 0x7F);
+        size_t mask = capacity() - 1;
+        for (size_t at = h >> 7 & mask;; at = (at + GROUP) & mask) {
+            for (uint32_t bits = matchByte(at, h2); bits; bits &= bits - 1) {
+                size_t slot = (at + lowestBit(bits)) & mask;
+                if (slots[slot].key == key) return slot;
+            }
+            if (matchEmpty(at)) return NONE;
+        }
+    }
+
+    // Key known to be absent and a free slot known to exist
+    void place(int32_t key, Value value) {
+        uint64_t h = hash(key);
+        size_t mask = capacity() - 1;
+        for (size_t at = h >> 7 & mask;; at = (at + GROUP) & mask) {
+            uint32_t bits = matchEmpty(at);
+            if (!bits) continue;
+            size_t slot = (at + lowestBit(bits)) & mask;
+            slots[slot].key = key;
+            slots[slot].value = std::move(value);
+            setControl(slot, static_cast<uint8_t>(h & 0x7F));
+            return;
+        }
+    }
+
+    void setControl(size_t slot, uint8_t byte) {
+        control[slot] = byte;
+        if (slot < GROUP - 1) control[capacity() + slot] = byte;
+    }
+
+    void allocate(size_t newCapacity) {
+        std::vector<uint8_t> oldControl(newCapacity + GROUP - 1, EMPTY);
+        std::vector<Slot> oldSlots(newCapacity);
+        oldControl.swap(control);
+        oldSlots.swap(slots);
+        for (size_t i = 0; i + GROUP - 1 < oldControl.size(); ++i) {
+            if (oldControl[i] != EMPTY) place(oldSlots[i].key, std::move(oldSlots[i].value));
+        }
+    }
+};
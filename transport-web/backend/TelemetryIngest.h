@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BoundedRing.h"
+#include "SwissTable.h"
+#include "VehicleTable.h"
+
+// Telemetry pipeline in front of a VehicleTable. Request threads drop
+// reports into one of several lock-free rings (one per hardware thread,
+// picked once per request thread, so producers rarely share a tail). A
+// background stage drains all rings, folds reports for the same vehicle
+// into one, and applies the survivors with a single lock per fleet shard,
+// so a burst of ticks costs readers a few short write locks instead of one
+// per report.
+class TelemetryIngest {
+public:
+    struct Stats {
+        uint64_t received;  // reports submitted
+        uint64_t applied;   // coalesced reports that reached a known vehicle
+        uint64_t coalesced; // reports folded into a later one
+        uint64_t unknown;   // reports for vehicles not in the table
+    };
+
+    explicit TelemetryIngest(VehicleTable& fleet, size_t ringCapacity = 1 << 14, size_t ringCount = 0)
+        : fleet(fleet) {
+        if (ringCount == 0) ringCount = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < ringCount; ++i) rings.emplace_back(new BoundedRing<VehicleUpdate>(ringCapacity));
+        worker = std::thread([this]() { run(); });
+    }
+
+    ~TelemetryIngest() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    TelemetryIngest(const TelemetryIngest&) = delete;
+    TelemetryIngest& operator=(const TelemetryIngest&) = delete;
+
+    // Queue reports for the background stage. When this thread's ring is
+    // full the caller waits for the stage to catch up rather than drop data.
+    void submit(const VehicleUpdate* updates, size_t n) {
+        BoundedRing<VehicleUpdate>& ring = *rings[ringIndex()];
+        for (size_t i = 0; i < n; ++i) {
+            while (!ring.push(updates[i])) {
+                wake.notify_one();
+                std::this_thread::yield();
+            }
+        }
+        received.fetch_add(n, std::memory_order_relaxed);
+        wake.notify_one();
+    }
+
+    // Block until everything submitted before the call is in the table:
+    // waits out one full drain that started after it
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        uint64_t ticket = ++flushRequests;
+        wake.notify_one();
+        drained.wait(lock, [&]() { return flushesDone >= ticket; });
+    }
+
+    Stats stats() const {
+        return {received.load(std::memory_order_relaxed), applied.load(std::memory_order_relaxed),
+                coalesced.load(std::memory_order_relaxed), unknown.load(std::memory_order_relaxed)};
+    }
+
+private:
+    VehicleTable& fleet;
+    std::vector<std::unique_ptr<BoundedRing<VehicleUpdate>>> rings;
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> applied{0};
+    std::atomic<uint64_t> coalesced{0};
+    std::atomic<uint64_t> unknown{0};
+
+    std::mutex mutex;
+    std::condition_variable wake;    // stage: reports may be waiting
+    std::condition_variable drained; // flush(): a drain finished
+    uint64_t flushRequests = 0;      // guarded by mutex
+    uint64_t flushesDone = 0;
+    bool stopping = false;
+    std::thread worker;
+
+    // Request threads are long-lived pool workers, so hand out rings
+    // round-robin on first use
+    size_t ringIndex() {
+        static std::atomic<size_t> nextThread{0};
+        thread_local size_t index = nextThread.fetch_add(1, std::memory_order_relaxed);
+        return index % rings.size();
+    }
+
+    void run() {
+        SwissTable<uint32_t> slotOf; // vehicle -> position in batch
+        std::vector<VehicleUpdate> batch;
+        for (;;) {
+            uint64_t serving;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                serving = flushRequests;
+            }
+            size_t taken = 0;
+            VehicleUpdate update;
+            for (auto& ring : rings) {
+                while (ring->pop(update)) {
+                    ++taken;
+                    if (uint32_t* slot = slotOf.find(update.vehicle)) {
+                        merge(batch[*slot], update);
+                    } else {
+                        slotOf.insertOrAssign(update.vehicle, static_cast<uint32_t>(batch.size()));
+                        batch.push_back(update);
+                    }
+                }
+            }
+            if (!batch.empty()) {
+                coalesced.fetch_add(taken - batch.size(), std::memory_order_relaxed);
+                size_t misses = fleet.apply(batch);
+                unknown.fetch_add(misses, std::memory_order_relaxed);
+                applied.fetch_add(batch.size() - misses, std::memory_order_relaxed);
+                batch.clear();
+                slotOf.clear();
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            flushesDone = serving;
+            drained.notify_all();
+            if (taken) continue;
+            if (stopping) return;
+            // Producers notify without the lock, so a short timeout covers a
+            // wakeup that raced with the drain above
+            wake.wait_for(lock, std::chrono::milliseconds(5),
+                          [&]() { return stopping || flushRequests > flushesDone; });
+        }
+    }
+
+    // Fold `next` into `into` field by field, newest report winning
+    static void merge(VehicleUpdate& into, const VehicleUpdate& next) {
+        bool newer = next.timestamp >= into.timestamp;
+        if (next.fields & VehicleUpdate::POSITION && (newer || !(into.fields & VehicleUpdate::POSITION))) {
+            into.lat = next.lat;
+            into.lon = next.lon;
+        }
+        if (next.fields & VehicleUpdate::STATION && (newer || !(into.fields & VehicleUpdate::STATION))) {
+            into.station = next.station;
+        }
+        if (next.fields & VehicleUpdate::STATUS && (newer || !(into.fields & VehicleUpdate::STATUS))) {
+            into.status = next.status;
+        }
+        into.fields |= next.fields;
+        into.timestamp = std::max(into.timestamp, next.timestamp);
+    }
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Parallel.h"
+#include "RoutingGraph.h"
+
+// Graph traversals over the CSR routing graph. Both return dense node
+// indices in visit order.
+class GraphTraversal {
+public:
+    // Graphs smaller than this are traversed on the calling thread only
+    static constexpr uint32_t PARALLEL_THRESHOLD = 50'000;
+
+    // Direction-optimizing BFS (Beamer et al.). Frontiers are kept as
+    // bitmaps; a level is expanded top-down while the frontier is small and
+    // bottom-up (unvisited nodes look for a parent in the frontier) once the
+    // frontier's edges outweigh the unexplored ones. Nodes are reported level
+    // by level, ascending index within a level.
+    static std::vector<uint32_t> bfs(const RoutingGraph& graph, uint32_t source) {
+        std::vector<uint32_t> order;
+        const uint32_t n = graph.nodeCount();
+        if (source >= n) return order;
+
+        const size_t words = (size_t(n) + 63) / 64;
+        Bitmap visited(words), frontierBits(words);
+        unsigned threads = n >= PARALLEL_THRESHOLD ? workerCount(n) : 1;
+
+        std::vector<uint32_t> frontier{source};
+        visited.set(source);
+        order.push_back(source);
+        uint64_t unexploredArcs = graph.arcCount() - degree(graph, source);
+        bool bottomUp = false;
+
+        while (!frontier.empty()) {
+            uint64_t frontierArcs = 0;
+            for (uint32_t v : frontier) frontierArcs += degree(graph, v);
+            if (!bottomUp && frontierArcs > unexploredArcs / ALPHA) bottomUp = true;
+            else if (bottomUp && frontier.size() < n / BETA) bottomUp = false;
+
+            std::vector<uint32_t> next = bottomUp
+                ? stepBottomUp(graph, frontier, visited, frontierBits, threads)
+                : stepTopDown(graph, frontier, visited, threads);
+            std::sort(next.begin(), next.end());
+            for (uint32_t v : next) unexploredArcs -= degree(graph, v);
+            order.insert(order.end(), next.begin(), next.end());
+            frontier.swap(next);
+        }
+        return order;
+    }
+
+    // Preorder DFS with an explicit stack of (node, next arc) pairs, so deep
+    // chains never hit a recursion limit. Neighbours are visited in CSR order,
+    // matching what a recursive DFS would produce.
+    static std::vector<uint32_t> dfs(const RoutingGraph& graph, uint32_t source) {
+        std::vector<uint32_t> order;
+        if (source >= graph.nodeCount()) return order;
+
+        std::vector<char> visited(graph.nodeCount(), 0);
+        std::vector<std::pair<uint32_t, uint32_t>> stack;
+        visited[source] = 1;
+        order.push_back(source);
+        stack.push_back({source, graph.arcBegin(source)});
+        while (!stack.empty()) {
+            auto& [u, arc] = stack.back();
+            if (arc == graph.arcEnd(u)) {
+                stack.pop_back();
+                continue;
+            }
+            uint32_t v = graph.arcTarget(arc++);
+            if (visited[v]) continue;
+            visited[v] = 1;
+            order.push_back(v);
+            stack.push_back({v, graph.arcBegin(v)});
+        }
+        return order;
+    }
+
+private:
+    // Switching thresholds from the direction-optimizing BFS paper
+    static constexpr uint64_t ALPHA = 14;
+    static constexpr uint32_t BETA = 24;
+
+    struct Bitmap {
+        std::unique_ptr<std::atomic<uint64_t>[]> bits;
+        size_t words;
+
+        explicit Bitmap(size_t words) : bits(new std::atomic<uint64_t>[words]), words(words) {
+            clear();
+        }
+        void clear() {
+            for (size_t i = 0; i < words; ++i) bits[i].store(0, std::memory_order_relaxed);
+        }
+        bool test(uint32_t v) const {
+            return (bits[v >> 6].load(std::memory_order_relaxed) >> (v & 63)) & 1;
+        }
+        void set(uint32_t v) {
+            bits[v >> 6].fetch_or(uint64_t(1) << (v & 63), std::memory_order_relaxed);
+        }
+        // Set the bit and report whether this call was the one that set it
+        bool claim(uint32_t v) {
+            uint64_t mask = uint64_t(1) << (v & 63);
+            return !(bits[v >> 6].fetch_or(mask, std::memory_order_relaxed) & mask);
+        }
+    };
+
+    static uint32_t degree(const RoutingGraph& graph, uint32_t v) {
+        return graph.arcEnd(v) - graph.arcBegin(v);
+    }
+
+    static std::vector<uint32_t> gather(std::vector<std::vector<uint32_t>>& parts) {
+        std::vector<uint32_t> all;
+        for (auto& part : parts) all.insert(all.end(), part.begin(), part.end());
+        return all;
+    }
+
+    // Frontier nodes push to unvisited neighbours, claiming them atomically
+    static std::vector<uint32_t> stepTopDown(const RoutingGraph& graph,
+                                             const std::vector<uint32_t>& frontier,
+                                             Bitmap& visited, unsigned threads) {
+        const size_t chunk = 1024;
+        const size_t chunks = (frontier.size() + chunk - 1) / chunk;
+        std::vector<std::vector<uint32_t>> parts(chunks);
+        parallelFor(chunks, [&](size_t c) {
+            size_t end = std::min(frontier.size(), (c + 1) * chunk);
+            for (size_t i = c * chunk; i < end; ++i) {
+                uint32_t u = frontier[i];
+                for (uint32_t e = graph.arcBegin(u); e < graph.arcEnd(u); ++e) {
+                    uint32_t v = graph.arcTarget(e);
+                    if (!visited.test(v) && visited.claim(v)) parts[c].push_back(v);
+                }
+            }
+        }, std::min<size_t>(threads, std::max<size_t>(chunks, 1)));
+        return gather(parts);
+    }
+
+    // Unvisited nodes pull from the frontier; each chunk owns whole bitmap
+    // words, so a node is only ever claimed by one worker
+    static std::vector<uint32_t> stepBottomUp(const RoutingGraph& graph,
+                                              const std::vector<uint32_t>& frontier,
+                                              Bitmap& visited, Bitmap& frontierBits,
+                                              unsigned threads) {
+        frontierBits.clear();
+        for (uint32_t v : frontier) frontierBits.set(v);
+
+        const uint32_t n = graph.nodeCount();
+        const uint32_t chunk = 64 * 256;
+        const size_t chunks = (size_t(n) + chunk - 1) / chunk;
+        std::vector<std::vector<uint32_t>> parts(chunks);
+        parallelFor(chunks, [&](size_t c) {
+            uint32_t end = static_cast<uint32_t>(std::min<size_t>(n, (c + 1) * chunk));
+            for (uint32_t v = static_cast<uint32_t>(c * chunk); v < end; ++v) {
+                if (visited.test(v)) continue;
+                for (uint32_t e = graph.arcBegin(v); e < graph.arcEnd(v); ++e) {
+                    if (frontierBits.test(graph.arcTarget(e))) {
+                        visited.set(v);
+                        parts[c].push_back(v);
+                        break;
+                    }
+                }
+            }
+        }, std::min<size_t>(threads, std::max<size_t>(chunks, 1)));
+        return gather(parts);
+    }
+};
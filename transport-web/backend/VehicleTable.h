@@ -0,0 +1,433 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "GeoIndex.h"
+#include "SwissTable.h"
+
+// One telemetry report. Only the fields named in `fields` are meant; the
+// status is a code from VehicleTable::statusCode().
+struct VehicleUpdate {
+    enum Field : uint8_t { POSITION = 1, STATION = 2, STATUS = 4 };
+
+    int32_t vehicle;
+    uint8_t fields;
+    uint8_t status;
+    int64_t station;
+    double lat, lon;
+    int64_t timestamp; // unix milliseconds
+};
+
+// Up to 255 short labels ("bus", "tram", "in_service") behind one-byte
+// codes, so records store an enum-sized code and filters compare bytes.
+// Labels never move once added, so resolving a code takes no lock.
+class LabelDictionary {
+public:
+    static constexpr size_t MAX_LABELS = 255;
+
+    LabelDictionary() = default;
+
+    // Pre-filled with `initial`, coded in order from 0
+    template <size_t N>
+    explicit LabelDictionary(const std::array<std::string_view, N>& initial) {
+        for (std::string_view label : initial) intern(label);
+    }
+
+    uint8_t intern(std::string_view label) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = codes.find(std::string(label));
+            if (it != codes.end()) return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = codes.find(std::string(label));
+        if (it != codes.end()) return it->second;
+        if (used == MAX_LABELS) throw std::runtime_error("Too many distinct labels");
+        uint8_t code = static_cast<uint8_t>(used++);
+        labels[code] = std::string(label);
+        codes.emplace(labels[code], code);
+        return code;
+    }
+
+    // Code of a label already interned, without adding it
+    std::optional<uint8_t> find(std::string_view label) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = codes.find(std::string(label));
+        if (it == codes.end()) return std::nullopt;
+        return it->second;
+    }
+
+    // Valid for any code returned by intern(), from any thread that received
+    // it through a lock or queue hand-off
+    const std::string& name(uint8_t code) const { return labels[code]; }
+
+private:
+    mutable std::shared_mutex mutex;
+    std::array<std::string, MAX_LABELS> labels;
+    size_t used = 0;
+    std::unordered_map<std::string, uint8_t> codes;
+};
+
+// Fleet store: vehicles held column by column (structure of arrays) in
+// reader-writer locked shards, with a Swiss table per shard from vehicle id
+// to row. Lookups on any shard run concurrently and a writer only blocks
+// its own shard, as in ShardedMap. Types and statuses are one-byte codes
+// from small dictionaries, so fleet-wide filters such as "all trams at
+// station X" are tight loops over a byte column and an int column rather
+// than walks over records holding strings. Rows are packed: erase moves
+// the last row into the hole.
+//
+// Positions change on every tick, so instead of a tree each shard keeps a
+// uniform grid of 0.01 degree cells (about 1 km) mapping a cell to the rows
+// inside it; a report that stays in its cell costs nothing extra, and one
+// that crosses a border moves a single row index between two lists.
+class VehicleTable {
+public:
+    static constexpr int64_t NO_STATION = -1;
+
+    // Statuses a report may carry, coded by position. The list is fixed so
+    // reports from any client cannot fill the status dictionary; anything
+    // else is recorded as "unknown".
+    static constexpr std::array<std::string_view, 6> STATUSES{"idle",        "in_service",     "active",
+                                                              "maintenance", "out_of_service", "unknown"};
+    static constexpr uint8_t IDLE_STATUS = 0;
+    static constexpr uint8_t UNKNOWN_STATUS = 5;
+
+    struct Vehicle {
+        int id;
+        std::string type;
+        std::string status;
+        int64_t station;
+        uint32_t capacity;
+        double lat, lon; // NaN until a position is reported
+        int64_t updated; // unix milliseconds of the last report, 0 if none
+    };
+
+    // Fleet-wide query; unset fields match everything
+    struct Filter {
+        std::optional<std::string> type;
+        std::optional<std::string> status;
+        std::optional<int64_t> station;
+    };
+
+    // Insert or overwrite; true when the id was new. Re-registering a
+    // vehicle changes its type and capacity and keeps its telemetry.
+    bool put(int id, std::string_view type, uint32_t capacity = 0) {
+        uint8_t typeCode = types.intern(type);
+        Shard& shard = shardOf(id);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (const uint32_t* row = shard.rowOf.find(id)) {
+            shard.type[*row] = typeCode;
+            shard.capacity[*row] = capacity;
+            return false;
+        }
+        shard.rowOf.insertOrAssign(id, static_cast<uint32_t>(shard.ids.size()));
+        shard.ids.push_back(id);
+        shard.type.push_back(typeCode);
+        shard.status.push_back(IDLE_STATUS);
+        shard.station.push_back(NO_STATION);
+        shard.capacity.push_back(capacity);
+        shard.lat.push_back(NAN);
+        shard.lon.push_back(NAN);
+        shard.updated.push_back(0);
+        shard.cell.push_back(NO_CELL);
+        shard.cellSlot.push_back(0);
+        count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    std::optional<Vehicle> get(int id) const {
+        const Shard& shard = shardOf(id);
+        Row row;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            const uint32_t* at = shard.rowOf.find(id);
+            if (!at) return std::nullopt;
+            row = shard.read(*at);
+        }
+        return resolve(row);
+    }
+
+    bool contains(int id) const {
+        const Shard& shard = shardOf(id);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.rowOf.find(id) != nullptr;
+    }
+
+    bool erase(int id) {
+        Shard& shard = shardOf(id);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        const uint32_t* at = shard.rowOf.find(id);
+        if (!at) return false;
+        uint32_t row = *at;
+        uint32_t last = static_cast<uint32_t>(shard.ids.size() - 1);
+        shard.unplace(row);
+        if (row != last) {
+            shard.moveRow(last, row);
+            shard.rowOf.insertOrAssign(shard.ids[row], row);
+        }
+        shard.popRow();
+        shard.rowOf.erase(id);
+        count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    // Code for a status string, for building VehicleUpdates; nullopt when it
+    // is not one of STATUSES
+    std::optional<uint8_t> statusCode(std::string_view status) const { return statuses.find(status); }
+
+    // Label behind a status code
+    const std::string& statusName(uint8_t code) const { return statuses.name(code); }
+
+    // Apply reports taking each shard's lock once. Reports older than what
+    // a vehicle already shows are ignored. Returns how many were for
+    // unknown vehicles; `updates` is reordered.
+    size_t apply(std::vector<VehicleUpdate>& updates) {
+        std::sort(updates.begin(), updates.end(), [](const VehicleUpdate& a, const VehicleUpdate& b) {
+            return shardIndex(a.vehicle) < shardIndex(b.vehicle);
+        });
+        size_t unknown = 0;
+        for (size_t begin = 0; begin < updates.size();) {
+            size_t index = shardIndex(updates[begin].vehicle);
+            size_t end = begin;
+            while (end < updates.size() && shardIndex(updates[end].vehicle) == index) ++end;
+            Shard& shard = shards[index];
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            for (size_t i = begin; i < end; ++i) {
+                const VehicleUpdate& update = updates[i];
+                const uint32_t* at = shard.rowOf.find(update.vehicle);
+                if (!at) {
+                    ++unknown;
+                    continue;
+                }
+                uint32_t row = *at;
+                if (update.timestamp < shard.updated[row]) continue;
+                if (update.fields & VehicleUpdate::POSITION) {
+                    shard.lat[row] = update.lat;
+                    shard.lon[row] = update.lon;
+                    if (cellOf(update.lat, update.lon) != shard.cell[row]) {
+                        shard.unplace(row);
+                        shard.place(row);
+                    }
+                }
+                if (update.fields & VehicleUpdate::STATION) shard.station[row] = update.station;
+                if (update.fields & VehicleUpdate::STATUS) shard.status[row] = update.status;
+                shard.updated[row] = update.timestamp;
+            }
+            begin = end;
+        }
+        return unknown;
+    }
+
+    // Vehicles matching every set field of the filter, sorted by id.
+    // Consistent per shard, not across the table.
+    std::vector<Vehicle> select(const Filter& filter) const {
+        // A label nobody has used yet can't match any row
+        std::optional<uint8_t> type, status;
+        if (filter.type && !(type = types.find(*filter.type))) return {};
+        if (filter.status && !(status = statuses.find(*filter.status))) return {};
+
+        bool anyType = !type, anyStatus = !status, anyStation = !filter.station;
+        uint8_t typeCode = type.value_or(0), statusCode = status.value_or(0);
+        int64_t station = filter.station.value_or(0);
+
+        std::vector<Row> rows;
+        std::vector<uint32_t> hits;
+        for (const Shard& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            size_t n = shard.ids.size();
+            hits.resize(n);
+            // Branch-free pass over the three filter columns: every row is
+            // written to `hits`, and the cursor only advances on a match
+            const uint8_t* typeColumn = shard.type.data();
+            const uint8_t* statusColumn = shard.status.data();
+            const int64_t* stationColumn = shard.station.data();
+            size_t found = 0;
+            for (size_t i = 0; i < n; ++i) {
+                hits[found] = static_cast<uint32_t>(i);
+                found += (anyType | (typeColumn[i] == typeCode)) & (anyStatus | (statusColumn[i] == statusCode)) &
+                         (anyStation | (stationColumn[i] == station));
+            }
+            for (size_t i = 0; i < found; ++i) rows.push_back(shard.read(hits[i]));
+        }
+        std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.id < b.id; });
+        std::vector<Vehicle> out;
+        out.reserve(rows.size());
+        for (const Row& row : rows) out.push_back(resolve(row));
+        return out;
+    }
+
+    // All vehicles sorted by id
+    std::vector<Vehicle> snapshot() const { return select(Filter{}); }
+
+    // Vehicles last reported within `meters` of the center, closest first,
+    // with their distance in meters
+    std::vector<std::pair<Vehicle, double>> within(GeoPoint center, double meters) const {
+        return resolve(withinRadius<Row>(center, meters, [this](const GeoBox& box, auto visit) { scan(box, visit); }));
+    }
+
+    // The k vehicles closest to the center, no farther than maxMeters
+    std::vector<std::pair<Vehicle, double>> nearest(GeoPoint center, size_t k, double maxMeters) const {
+        return resolve(nearestK<Row>(center, k, maxMeters, [this](const GeoBox& box, auto visit) { scan(box, visit); }));
+    }
+
+private:
+    static constexpr size_t SHARDS = 16;
+    static constexpr double CELL_DEGREES = 0.01;
+    static constexpr int32_t LON_CELLS = 36001; // 360 / CELL_DEGREES, +1 for lon == 180
+    static constexpr int32_t NO_CELL = -1;
+
+    struct Row {
+        int32_t id;
+        uint8_t type, status;
+        int64_t station;
+        uint32_t capacity;
+        double lat, lon;
+        int64_t updated;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        SwissTable<uint32_t> rowOf;
+        std::vector<int32_t> ids;
+        std::vector<uint8_t> type;
+        std::vector<uint8_t> status;
+        std::vector<int64_t> station;
+        std::vector<uint32_t> capacity;
+        std::vector<double> lat, lon;
+        std::vector<int64_t> updated;
+        std::vector<int32_t> cell;      // grid cell of the position, NO_CELL if none
+        std::vector<uint32_t> cellSlot; // index of the row in that cell's list
+        SwissTable<std::vector<uint32_t>> cells;
+
+        Row read(uint32_t row) const {
+            return {ids[row], type[row], status[row], station[row], capacity[row], lat[row], lon[row], updated[row]};
+        }
+
+        void moveRow(uint32_t from, uint32_t to) {
+            ids[to] = ids[from];
+            type[to] = type[from];
+            status[to] = status[from];
+            station[to] = station[from];
+            capacity[to] = capacity[from];
+            lat[to] = lat[from];
+            lon[to] = lon[from];
+            updated[to] = updated[from];
+            if (cell[from] != NO_CELL) (*cells.find(cell[from]))[cellSlot[from]] = to;
+            cell[to] = cell[from];
+            cellSlot[to] = cellSlot[from];
+        }
+
+        void popRow() {
+            ids.pop_back();
+            type.pop_back();
+            status.pop_back();
+            station.pop_back();
+            capacity.pop_back();
+            lat.pop_back();
+            lon.pop_back();
+            updated.pop_back();
+            cell.pop_back();
+            cellSlot.pop_back();
+        }
+
+        // Enter the row into the cell of its current position
+        void place(uint32_t row) {
+            cell[row] = cellOf(lat[row], lon[row]);
+            if (cell[row] == NO_CELL) return;
+            std::vector<uint32_t>* members = cells.find(cell[row]);
+            if (!members) {
+                cells.insertOrAssign(cell[row], {});
+                members = cells.find(cell[row]);
+            }
+            cellSlot[row] = static_cast<uint32_t>(members->size());
+            members->push_back(row);
+        }
+
+        // Take the row out of its cell, filling its slot with the cell's last row
+        void unplace(uint32_t row) {
+            if (cell[row] == NO_CELL) return;
+            std::vector<uint32_t>& members = *cells.find(cell[row]);
+            uint32_t moved = members.back();
+            members[cellSlot[row]] = moved;
+            cellSlot[moved] = cellSlot[row];
+            members.pop_back();
+            if (members.empty()) cells.erase(cell[row]);
+            cell[row] = NO_CELL;
+        }
+    };
+
+    LabelDictionary types;
+    LabelDictionary statuses{STATUSES};
+    std::array<Shard, SHARDS> shards;
+    std::atomic<size_t> count{0};
+
+    // Fibonacci hashing, independent of the hash SwissTable probes with
+    static size_t shardIndex(int id) {
+        return static_cast<size_t>((static_cast<uint32_t>(id) * 0x9E3779B97F4A7C15ull) >> 60) % SHARDS;
+    }
+
+    Vehicle resolve(const Row& row) const {
+        return {row.id, types.name(row.type), statuses.name(row.status), row.station, row.capacity,
+                row.lat, row.lon, row.updated};
+    }
+
+    std::vector<std::pair<Vehicle, double>> resolve(const std::vector<std::pair<Row, double>>& hits) const {
+        std::vector<std::pair<Vehicle, double>> out;
+        out.reserve(hits.size());
+        for (const auto& [row, meters] : hits) out.emplace_back(resolve(row), meters);
+        return out;
+    }
+
+    static int32_t cellOf(double lat, double lon) {
+        if (std::isnan(lat) || std::isnan(lon)) return NO_CELL;
+        return latCell(lat) * LON_CELLS + lonCell(lon);
+    }
+    static int32_t latCell(double lat) { return static_cast<int32_t>((lat + 90) / CELL_DEGREES); }
+    static int32_t lonCell(double lon) { return static_cast<int32_t>((lon + 180) / CELL_DEGREES); }
+
+    // visit(row, position) for at least every positioned vehicle in the box:
+    // through the grid when the box spans fewer cells than the shard has
+    // rows, else by scanning the position columns
+    template <typename Visit>
+    void scan(const GeoBox& box, Visit visit) const {
+        int32_t firstLat = latCell(box.minLat), lastLat = latCell(box.maxLat);
+        int32_t firstLon = lonCell(box.minLon), lastLon = lonCell(box.maxLon);
+        size_t spanned = size_t(lastLat - firstLat + 1) * size_t(lastLon - firstLon + 1);
+        for (const Shard& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (spanned > shard.ids.size()) {
+                for (uint32_t row = 0; row < shard.ids.size(); ++row) {
+                    GeoPoint at{shard.lat[row], shard.lon[row]};
+                    if (box.contains(at)) visit(shard.read(row), at);
+                }
+                continue;
+            }
+            for (int32_t y = firstLat; y <= lastLat; ++y) {
+                for (int32_t x = firstLon; x <= lastLon; ++x) {
+                    const std::vector<uint32_t>* members = shard.cells.find(y * LON_CELLS + x);
+                    if (!members) continue;
+                    for (uint32_t row : *members) visit(shard.read(row), GeoPoint{shard.lat[row], shard.lon[row]});
+                }
+            }
+        }
+    }
+
+    Shard& shardOf(int id) { return shards[shardIndex(id)]; }
+    const Shard& shardOf(int id) const { return shards[shardIndex(id)]; }
+};
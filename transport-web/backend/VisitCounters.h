@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "RoutingGraph.h"
+
+// Station visit counts for the turnstile endpoint, the hottest write path.
+// Each request thread counts into its own shard (picked once per thread, as
+// in TelemetryIngest), and shards sit on separate cache lines, so writers on
+// different cores never touch the same line and throughput grows with the
+// worker count. A shard's lock is only ever contended by a reader merging
+// the shards, which happens lazily when counts are asked for.
+class VisitCounters {
+public:
+    // 0 shards: one per hardware thread, at least httplib's default pool of 8
+    explicit VisitCounters(size_t shardCount = 0) {
+        if (shardCount == 0) shardCount = std::max(8u, std::thread::hardware_concurrency());
+        shards.reset(new Shard[shardCount]);
+        count = shardCount;
+    }
+
+    VisitCounters(const VisitCounters&) = delete;
+    VisitCounters& operator=(const VisitCounters&) = delete;
+
+    void record(StationId station, uint64_t visits = 1) {
+        Shard& shard = shards[shardIndex()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.visits[station] += visits;
+        shard.total += visits;
+    }
+
+    uint64_t visitsTo(StationId station) const {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            auto it = shards[i].visits.find(station);
+            if (it != shards[i].visits.end()) sum += it->second;
+        }
+        return sum;
+    }
+
+    uint64_t total() const {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            sum += shards[i].total;
+        }
+        return sum;
+    }
+
+    // Merged counts, busiest station first. Each shard is read atomically,
+    // the whole not: visits recorded during the merge may be partly included.
+    std::vector<std::pair<StationId, uint64_t>> totals() const {
+        std::unordered_map<StationId, uint64_t> merged;
+        for (size_t i = 0; i < count; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            for (const auto& [station, visits] : shards[i].visits) merged[station] += visits;
+        }
+        std::vector<std::pair<StationId, uint64_t>> out(merged.begin(), merged.end());
+        std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        return out;
+    }
+
+private:
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<StationId, uint64_t> visits;
+        uint64_t total = 0;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    size_t count;
+
+    size_t shardIndex() const {
+        static std::atomic<size_t> nextThread{0};
+        thread_local size_t index = nextThread.fetch_add(1, std::memory_order_relaxed);
+        return index % count;
+    }
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "MappedFile.h"
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Record body builder: a type byte, then fixed-width integers and
+// length-prefixed strings in native byte order
+class LogWriter {
+public:
+    explicit LogWriter(uint8_t type) : bytes(1, static_cast<char>(type)) {}
+
+    LogWriter& i64(int64_t value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof value);
+        return *this;
+    }
+
+    LogWriter& f64(double value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof value);
+        return *this;
+    }
+
+    LogWriter& str(std::string_view text) {
+        uint32_t length = static_cast<uint32_t>(text.size());
+        bytes.append(reinterpret_cast<const char*>(&length), sizeof length);
+        bytes.append(text);
+        return *this;
+    }
+
+    const std::string& body() const { return bytes; }
+
+private:
+    std::string bytes;
+};
+
+// Reads a record body back field by field. Reading past the end sets
+// failed() and yields zeros rather than throwing.
+class LogReader {
+public:
+    explicit LogReader(std::string_view body) : kind(static_cast<uint8_t>(body[0])), rest(body.substr(1)) {}
+
+    uint8_t type() const { return kind; }
+    bool failed() const { return bad; }
+
+    int64_t i64() {
+        int64_t value = 0;
+        take(&value, sizeof value);
+        return value;
+    }
+
+    double f64() {
+        double value = 0;
+        take(&value, sizeof value);
+        return value;
+    }
+
+    std::string str() {
+        uint32_t length = 0;
+        take(&length, sizeof length);
+        if (length > rest.size()) bad = true;
+        if (bad) return {};
+        std::string text(rest.substr(0, length));
+        rest.remove_prefix(length);
+        return text;
+    }
+
+private:
+    uint8_t kind;
+    std::string_view rest;
+    bool bad = false;
+
+    void take(void* out, size_t bytes) {
+        if (bytes > rest.size()) bad = true;
+        if (bad) return;
+        std::memcpy(out, rest.data(), bytes);
+        rest.remove_prefix(bytes);
+    }
+};
+
+// Append-only write-ahead log with group commit. Handlers append a record
+// (cheap: a copy into a shared buffer) and then wait for it to be durable; a
+// flusher thread writes whatever has accumulated and syncs once, so
+// concurrent writers share each fsync instead of paying for their own.
+//
+// Frame: { uint32 bodyLength, uint32 crc32(body), body }. Replay stops at
+// the first short or corrupt frame, which can only be a write torn by a
+// crash, and cuts it off.
+class WriteAheadLog {
+public:
+    WriteAheadLog() = default;
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    ~WriteAheadLog() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (flusher.joinable()) flusher.join();
+        if (fd >= 0) closeFile();
+    }
+
+    // Feed every intact record in `path` to fn(LogReader&), then open the
+    // file for appending. Returns the number of records replayed.
+    template <typename Fn>
+    size_t open(const std::string& path, Fn fn) {
+        fd = openFile(path);
+        if (fd < 0) throw std::runtime_error("Cannot open " + path);
+        size_t replayed = 0;
+        uint64_t valid = 0;
+        {
+            MappedFile file(path);
+            std::string_view data = file.view();
+            while (data.size() - valid >= 8) {
+                uint32_t length, crc;
+                std::memcpy(&length, data.data() + valid, 4);
+                std::memcpy(&crc, data.data() + valid + 4, 4);
+                if (length == 0 || length > data.size() - valid - 8) break;
+                std::string_view body = data.substr(valid + 8, length);
+                if (crc32(body) != crc) break;
+                LogReader reader(body);
+                fn(reader);
+                ++replayed;
+                valid += 8 + length;
+            }
+            if (valid < data.size() && !truncateFile(valid)) {
+                throw std::runtime_error("Cannot trim torn tail of " + path);
+            }
+        }
+        bytes = valid;
+        flusher = std::thread([this]() { flushLoop(); });
+        return replayed;
+    }
+
+    bool enabled() const { return fd >= 0; }
+
+    // Queue a record; returns its sequence number for waitDurable(). A
+    // disabled log returns 0, which is always durable.
+    uint64_t append(const LogWriter& record) {
+        if (fd < 0) return 0;
+        const std::string& body = record.body();
+        uint32_t header[2] = {static_cast<uint32_t>(body.size()), crc32(body)};
+        uint64_t sequence;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.append(reinterpret_cast<const char*>(header), sizeof header);
+            pending += body;
+            sequence = ++appended;
+        }
+        wake.notify_one();
+        return sequence;
+    }
+
+    // Block until the record is on disk. Throws if a flush failed, since
+    // the change was applied in memory but may not survive a restart.
+    void waitDurable(uint64_t sequence) {
+        if (sequence == 0) return;
+        std::unique_lock<std::mutex> lock(mutex);
+        flushed.wait(lock, [&]() { return durable >= sequence; });
+        if (failed) throw std::runtime_error("Write-ahead log flush failed");
+    }
+
+    // Empty the log once a snapshot holds everything in it. The caller must
+    // keep new records out until this returns.
+    void checkpoint() {
+        if (fd < 0) return;
+        std::unique_lock<std::mutex> lock(mutex);
+        flushed.wait(lock, [&]() { return durable == appended; });
+        if (!truncateFile(0) || !syncFile()) throw std::runtime_error("Cannot truncate write-ahead log");
+        bytes = 0;
+    }
+
+    // Records appended, fsyncs issued, bytes on disk
+    uint64_t recordCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return appended;
+    }
+    uint64_t syncCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return syncs;
+    }
+    uint64_t byteCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytes;
+    }
+
+private:
+    int fd = -1;
+    std::mutex mutex;
+    std::condition_variable wake;    // flusher: records are pending
+    std::condition_variable flushed; // writers: durable moved forward
+    std::string pending;
+    uint64_t appended = 0;
+    uint64_t durable = 0;
+    uint64_t syncs = 0;
+    uint64_t bytes = 0;
+    bool stopping = false;
+    bool failed = false;
+    std::thread flusher;
+
+    // Everything appended while a sync is in flight goes out in the next
+    // write, so one fsync covers a whole batch of handlers
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&]() { return stopping || !pending.empty(); });
+            if (pending.empty()) return;
+            std::string batch;
+            batch.swap(pending);
+            uint64_t upTo = appended;
+            lock.unlock();
+            bool ok = writeFile(batch) && syncFile();
+            lock.lock();
+            if (!ok) failed = true;
+            bytes += batch.size();
+            durable = upTo;
+            ++syncs;
+            flushed.notify_all();
+        }
+    }
+
+    static uint32_t crc32(std::string_view data) {
+        static const auto table = []() {
+            struct Table { uint32_t entries[256]; } t{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t.entries[i] = c;
+            }
+            return t;
+        }();
+        uint32_t crc = 0xFFFFFFFFu;
+        for (unsigned char byte : data) crc = table.entries[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+#ifdef _WIN32
+    static int openFile(const std::string& path) {
+        return ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0644);
+    }
+    bool writeFile(const std::string& data) {
+        return ::_write(fd, data.data(), static_cast<unsigned>(data.size())) == static_cast<int>(data.size());
+    }
+    bool syncFile() { return ::_commit(fd) == 0; }
+    bool truncateFile(uint64_t length) { return ::_chsize_s(fd, static_cast<__int64>(length)) == 0; }
+    void closeFile() { ::_close(fd); }
+#else
+    static int openFile(const std::string& path) {
+        return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    }
+    bool writeFile(const std::string& data) {
+        for (size_t done = 0; done < data.size();) {
+            ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+    bool syncFile() { return ::fsync(fd) == 0; }
+    bool truncateFile(uint64_t length) { return ::ftruncate(fd, static_cast<off_t>(length)) == 0; }
+    void closeFile() { ::close(fd); }
+#endif
+};
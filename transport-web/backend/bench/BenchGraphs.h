@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "../RoutingGraph.h"
+
+// Synthetic transit-like networks for the benchmarks: a sparse grid of
+// stations (about 60% of neighbouring links present, weights 1-20) plus a
+// few long express links, which is close to the shape of a city network.
+inline RoutingGraph makeTransitGraph(uint32_t stations, uint32_t seed = 42) {
+    std::mt19937 rng(seed);
+    std::vector<StationId> ids(stations);
+    for (uint32_t i = 0; i < stations; ++i) ids[i] = static_cast<StationId>(i) + 1;
+
+    const uint32_t side = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(double(stations))));
+    std::vector<RoutingGraph::Route> routes;
+    for (uint32_t i = 0; i < stations; ++i) {
+        if (i + 1 < stations && (i + 1) % side && rng() % 10 < 6) {
+            routes.emplace_back(ids[i], ids[i + 1], 1 + rng() % 20);
+        }
+        if (i + side < stations && rng() % 10 < 6) {
+            routes.emplace_back(ids[i], ids[i + side], 1 + rng() % 20);
+        }
+        if (rng() % 200 == 0) {
+            StationId other = ids[rng() % stations];
+            int weight = 1 + rng() % 50;
+            if (other != ids[i]) routes.emplace_back(ids[i], other, weight);
+        }
+    }
+
+    RoutingGraph graph;
+    graph.build(ids, routes);
+    return graph;
+}
+
+template <typename Fn>
+double elapsedMs(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,82 @@
+// Read-mostly contention on the station table: a global mutex, a single
+// reader-writer lock and the sharded map from ShardedMap.h, each hammered by
+// 1..N threads doing lookups with a share of renames mixed in.
+//   make bench && ./bench/contention_bench     default: 5% writes
+//   ./bench/contention_bench 20 16             20% writes, up to 16 threads
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "BenchGraphs.h"
+#include "ShardedMap.h"
+
+static const int KEYS = 10'000;
+static const int OPS_PER_THREAD = 400'000;
+
+// Same interface as ShardedMap for the two baselines
+template <typename Mutex, typename ReadLock>
+class LockedMap {
+public:
+    bool insertOrAssign(int key, std::string value) {
+        std::unique_lock<Mutex> lock(mutex);
+        return items.insert_or_assign(key, std::move(value)).second;
+    }
+    bool get(int key, std::string& out) const {
+        ReadLock lock(mutex);
+        auto it = items.find(key);
+        if (it == items.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+private:
+    mutable Mutex mutex;
+    std::unordered_map<int, std::string> items;
+};
+
+using MutexMap = LockedMap<std::mutex, std::unique_lock<std::mutex>>;
+using RwLockMap = LockedMap<std::shared_mutex, std::shared_lock<std::shared_mutex>>;
+
+template <typename Map>
+void run(const char* name, unsigned maxThreads, unsigned writePercent) {
+    std::printf("  %-9s", name);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        Map map;
+        for (int k = 0; k < KEYS; ++k) map.insertOrAssign(k, "Station " + std::to_string(k));
+
+        double ms = elapsedMs([&]() {
+            std::vector<std::thread> pool;
+            for (unsigned t = 0; t < threads; ++t) {
+                pool.emplace_back([&map, t, writePercent]() {
+                    std::mt19937 rng(t + 1);
+                    std::string name;
+                    for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                        int key = static_cast<int>(rng() % KEYS);
+                        if (rng() % 100 < writePercent) map.insertOrAssign(key, "Renamed");
+                        else map.get(key, name);
+                    }
+                });
+            }
+            for (auto& thread : pool) thread.join();
+        });
+        std::printf("  %2u thr %7.2f Mops/s", threads, threads * double(OPS_PER_THREAD) / ms / 1000.0);
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+    unsigned writePercent = argc > 1 ? std::atoi(argv[1]) : 5;
+    unsigned maxThreads = argc > 2 ? std::atoi(argv[2]) : std::max(8u, std::thread::hardware_concurrency());
+
+    std::printf("%d keys, %u%% writes, %d ops per thread\n", KEYS, writePercent, OPS_PER_THREAD);
+    run<MutexMap>("mutex", maxThreads, writePercent);
+    run<RwLockMap>("rwlock", maxThreads, writePercent);
+    run<ShardedMap<int, std::string>>("sharded", maxThreads, writePercent);
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Compares the priority queues from PriorityQueue.h on one-to-all and
+// point-to-point Dijkstra over synthetic transit networks.
+//   make bench && ./bench/queue_bench   default sizes
+//   ./bench/queue_bench 250000 20        custom size and query count
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "BenchGraphs.h"
+
+template <typename Queue>
+void run(const char* name, const RoutingGraph& graph, const std::vector<uint32_t>& sources) {
+    std::vector<int64_t> dist;
+    int64_t checksum = 0;
+    double oneToAll = elapsedMs([&]() {
+        for (uint32_t s : sources) {
+            graph.oneToAll<Queue>(s, dist);
+            checksum += dist[graph.nodeCount() / 2] == RoutingGraph::INF ? 0 : dist[graph.nodeCount() / 2];
+        }
+    });
+    double pointToPoint = elapsedMs([&]() {
+        for (size_t i = 0; i + 1 < sources.size(); ++i) {
+            auto result = graph.dijkstra<Queue>(graph.stationAt(sources[i]), graph.stationAt(sources[i + 1]));
+            checksum += result.found ? result.distance : 0;
+        }
+    });
+    std::printf("  %-11s one-to-all %8.2f ms/query   point-to-point %8.2f ms/query   (checksum %lld)\n",
+                name, oneToAll / sources.size(), pointToPoint / std::max<size_t>(1, sources.size() - 1),
+                static_cast<long long>(checksum));
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint32_t> sizes = {10'000, 100'000, 500'000};
+    uint32_t queries = argc > 2 ? std::atoi(argv[2]) : 10;
+    if (argc > 1) sizes = {static_cast<uint32_t>(std::atoi(argv[1]))};
+
+    for (uint32_t size : sizes) {
+        RoutingGraph graph = makeTransitGraph(size);
+        std::mt19937 rng(7);
+        std::vector<uint32_t> sources(queries);
+        for (auto& s : sources) s = rng() % graph.nodeCount();
+
+        std::printf("%u stations, %u arcs\n", graph.nodeCount(), graph.arcCount());
+        run<BinaryHeap>("binary", graph, sources);
+        run<QuaternaryHeap>("quaternary", graph, sources);
+        run<RadixHeap>("radix", graph, sources);
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Turnstile write path: station visit counts recorded by 1..N threads into a
+// single mutex-guarded map, a shared array of atomic counters, and the
+// per-thread shards of VisitCounters.h. Only the sharded counters should
+// scale with threads; the others bounce one lock or a few hot cache lines
+// between cores.
+//   make bench && ./bench/visit_bench       default: 1000 stations
+//   ./bench/visit_bench 50 16               50 stations, up to 16 threads
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "BenchGraphs.h"
+#include "VisitCounters.h"
+
+static const int VISITS_PER_THREAD = 2'000'000;
+
+class MutexCounters {
+public:
+    explicit MutexCounters(size_t) {}
+    void record(StationId station) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++visits[station];
+    }
+    uint64_t total() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t sum = 0;
+        for (const auto& entry : visits) sum += entry.second;
+        return sum;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<StationId, uint64_t> visits;
+};
+
+// Lock-free but shared: neighbouring stations share cache lines
+class AtomicCounters {
+public:
+    explicit AtomicCounters(size_t stations) : visits(new std::atomic<uint64_t>[stations]()), stations(stations) {}
+    void record(StationId station) { visits[station].fetch_add(1, std::memory_order_relaxed); }
+    uint64_t total() const {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < stations; ++i) sum += visits[i].load(std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> visits;
+    size_t stations;
+};
+
+class ShardedCounters {
+public:
+    explicit ShardedCounters(size_t) {}
+    void record(StationId station) { counters.record(station); }
+    uint64_t total() const { return counters.total(); }
+
+private:
+    VisitCounters counters;
+};
+
+template <typename Counters>
+void run(const char* name, unsigned maxThreads, unsigned stations) {
+    std::printf("  %-8s", name);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        Counters counters(stations);
+        double ms = elapsedMs([&]() {
+            std::vector<std::thread> pool;
+            for (unsigned t = 0; t < threads; ++t) {
+                pool.emplace_back([&counters, t, stations]() {
+                    std::mt19937 rng(t + 1);
+                    for (int i = 0; i < VISITS_PER_THREAD; ++i) counters.record(static_cast<StationId>(rng() % stations));
+                });
+            }
+            for (auto& thread : pool) thread.join();
+        });
+        if (counters.total() != uint64_t(threads) * VISITS_PER_THREAD) std::printf(" [lost visits]");
+        std::printf("  %2u thr %7.2f Mops/s", threads, threads * double(VISITS_PER_THREAD) / ms / 1000.0);
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+    unsigned stations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000;
+    unsigned maxThreads = argc > 2 ? std::atoi(argv[2]) : std::max(8u, std::thread::hardware_concurrency());
+
+    std::printf("%u stations, %d visits per thread, %u hardware threads\n", stations, VISITS_PER_THREAD,
+                std::thread::hardware_concurrency());
+    run<MutexCounters>("mutex", maxThreads, stations);
+    run<AtomicCounters>("atomic", maxThreads, stations);
+    run<ShardedCounters>("sharded", maxThreads, stations);
+    return 0;
+}
@@ -11,40 +11,604 @@
 #include <sstream>
 #include <thread>
 #include <chrono>
+#include <cmath>
 #include <functional>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <mutex>
+#include <shared_mutex>
+#include <fstream>
 #include "httplib.h"
 #include "json.hpp"
+#include "RoutingGraph.h"
+#include "ContractionHierarchy.h"
+#include "Landmarks.h"
+#include "DistanceMatrix.h"
+#include "Traversal.h"
+#include "PathCache.h"
+#include "Isochrone.h"
+#include "IncrementalSpt.h"
+#include "ShardedMap.h"
+#include "GraphSnapshot.h"
+#include "BulkImport.h"
+#include "GtfsLoader.h"
+#include "NetworkSnapshot.h"
+#include "WriteAheadLog.h"
+#include "GeoIndex.h"
+#include "VisitCounters.h"
+#include "PriorityPassengerQueue.h"
+#include "VehicleTable.h"
+#include "TelemetryIngest.h"
 
 using json = nlohmann::json;
 using namespace std;
 
+// Reads a telemetry body straight from the token stream into VehicleUpdates,
+// without building a DOM. The body is {"updates": [report...]} or a bare
+// array of reports; a report is {"id", "lat", "lon", "station", "status",
+// "timestamp"} where only id is required and lat/lon come as a pair. A
+// status outside VehicleTable::STATUSES is recorded as "unknown".
+class TelemetryReader : public nlohmann::json_sax<json> {
+public:
+    TelemetryReader(const VehicleTable& fleet, int64_t now, std::vector<VehicleUpdate>& out)
+        : fleet(fleet), now(now), out(out) {}
+
+    const std::string& error() const { return problem; }
+    size_t unknownStatuses() const { return unknownStatus; }
+
+    bool null() override { return depth != reportDepth || fail("null " + field); }
+    bool boolean(bool) override { return depth != reportDepth || fail("unexpected boolean for " + field); }
+    bool number_integer(number_integer_t value) override { return integer(value, static_cast<double>(value)); }
+    bool number_unsigned(number_unsigned_t value) override {
+        return integer(static_cast<int64_t>(value), static_cast<double>(value));
+    }
+    bool number_float(number_float_t value, const string_t&) override {
+        if (depth != reportDepth) return true;
+        if (field == "lat") return setLat(value);
+        if (field == "lon") return setLon(value);
+        return fail(field + " must be an integer");
+    }
+    bool string(string_t& value) override {
+        if (depth != reportDepth) return true;
+        if (field != "status") return fail("unexpected string for " + field);
+        std::optional<uint8_t> code = fleet.statusCode(value);
+        if (!code) ++unknownStatus;
+        current.status = code.value_or(VehicleTable::UNKNOWN_STATUS);
+        current.fields |= VehicleUpdate::STATUS;
+        return true;
+    }
+    bool binary(binary_t&) override { return true; }
+
+    bool start_object(std::size_t) override {
+        ++depth;
+        if (depth == reportDepth) {
+            current = VehicleUpdate{0, 0, 0, VehicleTable::NO_STATION, 0, 0, now};
+            hasId = hasLat = hasLon = false;
+        } else if (reportDepth == 0 && depth != 1) {
+            return fail("Expected an array of reports");
+        }
+        return true;
+    }
+    bool key(string_t& name) override {
+        field = name;
+        return true;
+    }
+    bool end_object() override {
+        if (depth-- != reportDepth) return true;
+        if (!hasId) return fail("Report without id");
+        if (hasLat != hasLon) return fail("lat and lon must be given together");
+        if (hasLat) current.fields |= VehicleUpdate::POSITION;
+        out.push_back(current);
+        return true;
+    }
+    bool start_array(std::size_t) override {
+        ++depth;
+        if (reportDepth == 0 && (depth == 1 || (depth == 2 && field == "updates"))) reportDepth = depth + 1;
+        return true;
+    }
+    bool end_array() override {
+        --depth;
+        return true;
+    }
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) override {
+        return fail(e.what());
+    }
+
+private:
+    const VehicleTable& fleet;
+    int64_t now;
+    std::vector<VehicleUpdate>& out;
+    size_t unknownStatus = 0;
+    std::string problem;
+    std::string field; // last key seen
+    int depth = 0;
+    int reportDepth = 0; // object depth of a report, once the array is found
+    VehicleUpdate current{};
+    bool hasId = false, hasLat = false, hasLon = false;
+
+    bool fail(std::string message) {
+        if (problem.empty()) problem = std::move(message);
+        return false;
+    }
+
+    bool integer(int64_t value, double asDouble) {
+        if (depth != reportDepth) return true;
+        if (field == "id") {
+            if (value < INT32_MIN || value > INT32_MAX) return fail("id out of range");
+            current.vehicle = static_cast<int32_t>(value);
+            hasId = true;
+        } else if (field == "station") {
+            current.station = value;
+            current.fields |= VehicleUpdate::STATION;
+        } else if (field == "timestamp") {
+            current.timestamp = value;
+        } else if (field == "lat") {
+            return setLat(asDouble);
+        } else if (field == "lon") {
+            return setLon(asDouble);
+        }
+        return true;
+    }
+
+    bool setLat(double value) {
+        if (!(value >= -90 && value <= 90)) return fail("lat out of range");
+        current.lat = value;
+        hasLat = true;
+        return true;
+    }
+
+    bool setLon(double value) {
+        if (!(value >= -180 && value <= 180)) return fail("lon out of range");
+        current.lon = value;
+        hasLon = true;
+        return true;
+    }
+};
+
 // Enhanced Transport API with better integration
 class EnhancedTransportAPI {
 private:
-    std::map<int, std::string> stations;
-    std::vector<std::tuple<int, int, int>> routes; // source, dest, weight
-    std::vector<std::pair<int, std::string>> vehicles;
-    std::vector<std::pair<int, std::string>> passengers;
+    // httplib serves requests from a thread pool. Stations and vehicles live
+    // in sharded reader-writer tables so lookups scale across workers; the
+    // passenger queue takes arrivals through a lock-free ring and serves
+    // them by priority class; turnstile visits go to per-thread counters.
+    ShardedMap<StationId, std::string> stations;
+    VehicleTable vehicles;
+    TelemetryIngest telemetry{vehicles};
+    std::atomic<uint64_t> unknownStatuses{0}; // reported statuses outside VehicleTable::STATUSES
+    PriorityPassengerQueue passengers{1 << 16};
+    VisitCounters visits;
+
+    // Station coordinates where known. Nearby queries search a packed
+    // Hilbert R-tree over them, rebuilt by the first query after a change;
+    // vehicles keep their own grid inside the fleet table.
+    struct StationTree {
+        uint64_t version = 0;
+        std::vector<StationId> ids; // by point
+        std::vector<GeoPoint> points;
+        HilbertRTree tree;
+    };
+    ShardedMap<StationId, GeoPoint> stationPositions;
+    std::atomic<uint64_t> positionsVersion{0};
+    std::mutex stationTreeMutex; // one rebuild at a time
+    RcuCell<StationTree> stationTree{std::make_shared<const StationTree>()};
+
+    // Routing state is read-copy-update: queries pin the current immutable
+    // snapshot and never take a lock, while writers (serialized by
+    // writeMutex) build a new snapshot and publish it with an atomic swap.
+    std::mutex writeMutex;
+    std::vector<RoutingGraph::Route> routes; // source, dest, weight; writers only
+    RcuCell<GraphSnapshot> routing{std::make_shared<const GraphSnapshot>()};
+
+    // Recent shortest-path results, keyed by graph epoch
+    PathCache pathCache{4096};
+
+    // Shortest-path trees of frequently queried origins, repaired on route
+    // edits rather than recomputed
+    HotOriginTrees hotTrees{32, 3};
+
+    // Contraction hierarchy, built in the background for the current graph
+    std::mutex hierarchyMutex;
+    std::shared_ptr<const ContractionHierarchy> hierarchy;
+    bool hierarchyBuilding = false;
+    std::thread hierarchyWorker;
+
+    // ALT landmarks; refreshed on demand, kept across route slow-downs
+    std::mutex landmarkMutex;
+    uint32_t landmarkTarget = 16;
+    LandmarkIndex::Selection landmarkSelection = LandmarkIndex::Selection::Avoid;
+    std::shared_ptr<const LandmarkIndex> landmarks;
+    uint64_t landmarkVersion = 0;
+
+    // Binary network snapshot written by POST /api/snapshot, read at startup
+    std::string snapshotPath;
+    std::string gtfsReport; // import summary of the feed loaded at startup, if any
+
+    // Every mutation is logged before it is acknowledged and replayed on top
+    // of the snapshot at startup; a snapshot empties the log and re-logs the
+    // passenger queue and the fleet. Renames, passenger and vehicle
+    // operations skip writeMutex, so they hold checkpointMutex shared and a
+    // snapshot holds it exclusively.
+    // Lock order: checkpointMutex, then writeMutex.
+    WriteAheadLog wal;
+    std::shared_mutex checkpointMutex;
+    size_t replayedRecords = 0;
+
+    enum LogRecord : uint8_t {
+        STATION_PUT = 1, // id, name
+        STATION_DELETE,  // id
+        ROUTE_PUT,       // source, dest, weight
+        ROUTE_DELETE,    // source, dest
+        IMPORT,          // station count, (id, name)..., route count, (source, dest, weight)...
+        PASSENGER_ENQUEUE, // id, name, class, deadline
+        PASSENGER_DEQUEUE, // id
+        PASSENGER_ENQUEUE_BATCH, // count, (id, name, class, deadline)...
+        PASSENGER_DEQUEUE_BATCH, // count, id...
+        STATION_PUT_AT,          // id, name, lat, lon
+        IMPORT_AT,               // as IMPORT, with lat, lon after each name
+        VEHICLE_PUT,             // id, type, capacity
+        VEHICLE_DELETE,          // id
+        VEHICLE_TELEMETRY        // count, (id, fields, status, station, lat, lon, timestamp)...
+    };
+
+    // Writers only: rebuild the CSR graph from stations and routes and
+    // publish it as the next snapshot
+    std::shared_ptr<const GraphSnapshot> rebuildGraph() {
+        auto next = std::make_shared<GraphSnapshot>();
+        std::vector<StationId> ids;
+        ids.reserve(stations.size());
+        for (const auto& station : stations.snapshot()) ids.push_back(station.first);
+        next->graph.build(ids, routes);
+        return publishGraph(next);
+    }
+
+    std::shared_ptr<const GraphSnapshot> publishGraph(std::shared_ptr<GraphSnapshot> next) {
+        next->epoch = routing.pin()->epoch + 1;
+        routing.publish(next);
+        return next;
+    }
+
+    // Station ids keep their dense index across route edits, so hot trees
+    // can be repaired; any station change invalidates them
+    void stationsChanged() {
+        hotTrees.clear();
+        rebuildGraph();
+    }
+
+    void placeStation(StationId id, GeoPoint position) {
+        stationPositions.insertOrAssign(id, position);
+        positionsVersion.fetch_add(1, std::memory_order_release);
+    }
+
+    void unplaceStation(StationId id) {
+        if (stationPositions.erase(id)) positionsVersion.fetch_add(1, std::memory_order_release);
+    }
+
+    // R-tree over the current station positions
+    std::shared_ptr<const StationTree> currentStationTree() {
+        std::shared_ptr<const StationTree> current = stationTree.pin();
+        if (current->version == positionsVersion.load(std::memory_order_acquire)) return current;
+        std::lock_guard<std::mutex> lock(stationTreeMutex);
+        current = stationTree.pin();
+        uint64_t version = positionsVersion.load(std::memory_order_acquire);
+        if (current->version == version) return current;
+        // Read the version first: a change racing with the copy bumps it
+        // again, and the next query rebuilds
+        auto next = std::make_shared<StationTree>();
+        next->version = version;
+        for (const auto& [id, position] : stationPositions.snapshot()) {
+            next->ids.push_back(id);
+            next->points.push_back(position);
+        }
+        next->tree = HilbertRTree(next->points);
+        stationTree.publish(next);
+        return next;
+    }
+
+    void repairHotTrees(const GraphSnapshot& before, const GraphSnapshot& after,
+                        StationId source, StationId dest, int64_t oldWeight, int64_t newWeight) {
+        if (hotTrees.size() == 0) return;
+        auto weightOf = [](int64_t w) { return w < 0 ? RoutingGraph::INF : w; };
+        hotTrees.edgeChanged(after.graph, before.epoch, after.epoch, source, dest,
+                             weightOf(oldWeight), weightOf(newWeight));
+    }
+
+    std::string stationName(StationId id) const {
+        std::string name;
+        stations.get(id, name);
+        return name;
+    }
+
+    // Hierarchy matching the snapshot, or nullptr while one is being built.
+    // A stale hierarchy triggers a background build that pins the snapshot.
+    std::shared_ptr<const ContractionHierarchy> currentHierarchy(const std::shared_ptr<const GraphSnapshot>& snapshot) {
+        std::lock_guard<std::mutex> lock(hierarchyMutex);
+        if (hierarchy && hierarchy->version() == snapshot->epoch) return hierarchy;
+        if (!hierarchyBuilding && snapshot->epoch == routing.pin()->epoch) {
+            hierarchyBuilding = true;
+            if (hierarchyWorker.joinable()) hierarchyWorker.join();
+            hierarchyWorker = std::thread([this, snapshot]() {
+                auto built = std::make_shared<const ContractionHierarchy>(snapshot->graph, snapshot->epoch);
+                std::lock_guard<std::mutex> lock(hierarchyMutex);
+                hierarchy = built;
+                hierarchyBuilding = false;
+            });
+        }
+        return nullptr;
+    }
+
+    bool landmarksCurrent(uint64_t epoch) {
+        std::lock_guard<std::mutex> lock(landmarkMutex);
+        return landmarks && landmarkVersion == epoch;
+    }
+
+    // Landmarks valid for the snapshot's graph. A refresh works on a copy; a
+    // reader behind the latest refresh gets a private index.
+    std::shared_ptr<const LandmarkIndex> currentLandmarks(const GraphSnapshot& snapshot) {
+        std::lock_guard<std::mutex> lock(landmarkMutex);
+        if (landmarks && landmarkVersion == snapshot.epoch) return landmarks;
+        auto next = landmarks ? std::make_shared<LandmarkIndex>(*landmarks)
+                              : std::make_shared<LandmarkIndex>(landmarkTarget, landmarkSelection);
+        next->refresh(snapshot.graph);
+        if (!landmarks || snapshot.epoch > landmarkVersion) {
+            landmarks = next;
+            landmarkVersion = snapshot.epoch;
+        }
+        return next;
+    }
+
+    // Adopt a snapshot file: the graph and any saved hierarchy and landmarks
+    // are used straight from the mapping
+    void restoreSnapshot() {
+        uint64_t epoch = routing.pin()->epoch + 1;
+        NetworkSnapshot::Contents loaded = NetworkSnapshot::load(snapshotPath, epoch);
+        for (uint32_t node = 0; node < loaded.graph.nodeCount(); ++node) {
+            stations.insertOrAssign(loaded.graph.stationAt(node), std::string(loaded.nameAt(node)));
+        }
+        for (uint32_t node = 0; node < loaded.positions.size(); ++node) {
+            if (!std::isnan(loaded.positions[node].lat)) placeStation(loaded.graph.stationAt(node), loaded.positions[node]);
+        }
+        routes = NetworkSnapshot::routesOf(loaded.graph);
+        auto next = std::make_shared<GraphSnapshot>();
+        next->graph = std::move(loaded.graph);
+        publishGraph(next);
+        hierarchy = loaded.hierarchy;
+        if (loaded.landmarks) {
+            landmarks = loaded.landmarks;
+            landmarkVersion = epoch;
+            landmarkTarget = landmarks->targetCount();
+            landmarkSelection = landmarks->selectionMode();
+        }
+    }
+
+    // Apply logged mutations straight to stations and routes, then rebuild
+    // once. Records only set or delete, so replaying a log whose effects a
+    // snapshot already holds (a crash mid-checkpoint) changes nothing.
+    void replayLog(const std::string& logFile) {
+        std::unordered_map<std::pair<StationId, StationId>, size_t, RoutePairHash> position;
+        for (size_t i = 0; i < routes.size(); ++i) {
+            position[routePair(std::get<0>(routes[i]), std::get<1>(routes[i]))] = i;
+        }
+        auto putRoute = [&](StationId source, StationId dest, int weight) {
+            auto [it, inserted] = position.try_emplace(routePair(source, dest), routes.size());
+            if (inserted) routes.push_back({source, dest, weight});
+            else std::get<2>(routes[it->second]) = weight;
+        };
+        auto removeRoute = [&](size_t i) {
+            position.erase(routePair(std::get<0>(routes[i]), std::get<1>(routes[i])));
+            if (i + 1 != routes.size()) {
+                routes[i] = routes.back();
+                position[routePair(std::get<0>(routes[i]), std::get<1>(routes[i]))] = i;
+            }
+            routes.pop_back();
+        };
+
+        // Passengers are logged after they are queued, so a dequeue can be
+        // logged before its enqueue; it then cancels that enqueue instead
+        std::vector<PriorityPassengerQueue::Passenger> queued;
+        std::vector<char> served;
+        std::unordered_map<int, std::vector<size_t>> waiting; // id -> queued positions, newest last
+        std::unordered_map<int, size_t> early;                // dequeues seen before their enqueue
+        auto replayEnqueue = [&](LogReader& record) {
+            int id = static_cast<int>(record.i64());
+            std::string name = record.str();
+            auto priority = static_cast<PassengerClass>(record.i64());
+            int64_t deadline = record.i64();
+            if (record.failed()) return;
+            auto debt = early.find(id);
+            if (debt != early.end()) {
+                if (--debt->second == 0) early.erase(debt);
+                return;
+            }
+            waiting[id].push_back(queued.size());
+            queued.push_back({id, std::move(name), priority, deadline});
+            served.push_back(0);
+        };
+        auto replayDequeue = [&](LogReader& record) {
+            int id = static_cast<int>(record.i64());
+            if (record.failed()) return;
+            auto it = waiting.find(id);
+            if (it == waiting.end()) {
+                ++early[id];
+                return;
+            }
+            served[it->second.front()] = 1;
+            it->second.erase(it->second.begin());
+            if (it->second.empty()) waiting.erase(it);
+        };
+
+        replayedRecords = wal.open(logFile, [&](LogReader& record) {
+            switch (record.type()) {
+                case PASSENGER_ENQUEUE:
+                    replayEnqueue(record);
+                    break;
+                case PASSENGER_DEQUEUE:
+                    replayDequeue(record);
+                    break;
+                case PASSENGER_ENQUEUE_BATCH:
+                    for (int64_t i = 0, n = record.i64(); i < n && !record.failed(); ++i) replayEnqueue(record);
+                    break;
+                case PASSENGER_DEQUEUE_BATCH:
+                    for (int64_t i = 0, n = record.i64(); i < n && !record.failed(); ++i) replayDequeue(record);
+                    break;
+                case STATION_PUT: {
+                    StationId id = record.i64();
+                    std::string name = record.str();
+                    if (!record.failed()) stations.insertOrAssign(id, name);
+                    break;
+                }
+                case STATION_PUT_AT: {
+                    StationId id = record.i64();
+                    std::string name = record.str();
+                    GeoPoint position{record.f64(), record.f64()};
+                    if (record.failed()) break;
+                    stations.insertOrAssign(id, name);
+                    placeStation(id, position);
+                    break;
+                }
+                case STATION_DELETE: {
+                    StationId id = record.i64();
+                    if (record.failed()) break;
+                    stations.erase(id);
+                    unplaceStation(id);
+                    for (size_t i = routes.size(); i-- > 0;) {
+                        if (std::get<0>(routes[i]) == id || std::get<1>(routes[i]) == id) removeRoute(i);
+                    }
+                    break;
+                }
+                case ROUTE_PUT: {
+                    StationId source = record.i64(), dest = record.i64();
+                    int weight = static_cast<int>(record.i64());
+                    if (!record.failed()) putRoute(source, dest, weight);
+                    break;
+                }
+                case ROUTE_DELETE: {
+                    StationId source = record.i64(), dest = record.i64();
+                    auto it = position.find(routePair(source, dest));
+                    if (!record.failed() && it != position.end()) removeRoute(it->second);
+                    break;
+                }
+                case VEHICLE_PUT: {
+                    int id = static_cast<int>(record.i64());
+                    std::string type = record.str();
+                    auto capacity = static_cast<uint32_t>(record.i64());
+                    if (!record.failed()) vehicles.put(id, type, capacity);
+                    break;
+                }
+                case VEHICLE_DELETE: {
+                    int id = static_cast<int>(record.i64());
+                    if (!record.failed()) vehicles.erase(id);
+                    break;
+                }
+                case VEHICLE_TELEMETRY: {
+                    std::vector<VehicleUpdate> updates;
+                    for (int64_t i = 0, n = record.i64(); i < n && !record.failed(); ++i) {
+                        VehicleUpdate update{};
+                        update.vehicle = static_cast<int32_t>(record.i64());
+                        update.fields = static_cast<uint8_t>(record.i64());
+                        std::string status = record.str();
+                        update.station = record.i64();
+                        update.lat = record.f64();
+                        update.lon = record.f64();
+                        update.timestamp = record.i64();
+                        if (record.failed()) break;
+                        update.status = vehicles.statusCode(status).value_or(VehicleTable::UNKNOWN_STATUS);
+                        updates.push_back(update);
+                    }
+                    vehicles.apply(updates);
+                    break;
+                }
+                case IMPORT:
+                case IMPORT_AT: {
+                    bool placed = record.type() == IMPORT_AT;
+                    for (int64_t i = 0, n = record.i64(); i < n && !record.failed(); ++i) {
+                        StationId id = record.i64();
+                        std::string name = record.str();
+                        GeoPoint position{NAN, NAN};
+                        if (placed) position = {record.f64(), record.f64()};
+                        if (record.failed()) break;
+                        stations.insertOrAssign(id, name);
+                        if (!std::isnan(position.lat)) placeStation(id, position);
+                    }
+                    for (int64_t i = 0, n = record.i64(); i < n && !record.failed(); ++i) {
+                        StationId source = record.i64(), dest = record.i64();
+                        int weight = static_cast<int>(record.i64());
+                        if (!record.failed()) putRoute(source, dest, weight);
+                    }
+                    break;
+                }
+            }
+        });
+        for (size_t i = 0; i < queued.size(); ++i) {
+            if (!served[i]) passengers.enqueue(queued[i].id, queued[i].name, queued[i].priority, queued[i].deadline);
+        }
+        if (replayedRecords) {
+            // Logs written before addRoute validated its input can hold
+            // routes the graph never had; drop them so build() accepts the rest
+            for (size_t i = routes.size(); i-- > 0;) {
+                auto [source, dest, weight] = routes[i];
+                if (routeIssue(source, dest, weight, [&](StationId id) { return stations.contains(id); })) {
+                    removeRoute(i);
+                }
+            }
+            hotTrees.clear();
+            rebuildGraph();
+        }
+    }
+
+    std::string hierarchyState() {
+        uint64_t epoch = routing.pin()->epoch;
+        std::lock_guard<std::mutex> lock(hierarchyMutex);
+        if (hierarchyBuilding) return "building";
+        if (hierarchy && hierarchy->version() == epoch) return "ready";
+        return "stale";
+    }
 
 public:
-    EnhancedTransportAPI() {
-        // Initialize with some demo data
-        stations[1] = "Central Station";
-        stations[2] = "North Terminal";
-        stations[3] = "South Hub";
-        stations[4] = "East Junction";
-        stations[5] = "West Plaza";
-        
-        routes.push_back({1, 2, 5});
-        routes.push_back({1, 3, 7});
-        routes.push_back({1, 4, 3});
-        routes.push_back({1, 5, 4});
-        
-        vehicles.push_back({101, "bus"});
-        vehicles.push_back({102, "metro"});
-        vehicles.push_back({103, "tram"});
+    // Restores the network from `snapshotFile` when it exists, otherwise
+    // starts from the GTFS feed in `gtfsDirectory` or the demo network, with
+    // the demo fleet; then replays `logFile` on top. A feed is ignored once a
+    // snapshot exists, since the snapshot already holds it.
+    explicit EnhancedTransportAPI(const std::string& snapshotFile = "", const std::string& logFile = "",
+                                  const std::string& gtfsDirectory = "")
+        : snapshotPath(snapshotFile) {
+        std::ifstream existing(snapshotPath, std::ios::binary);
+        bool restored = !snapshotPath.empty() && existing;
+        if (restored) {
+            restoreSnapshot();
+        } else if (!gtfsDirectory.empty()) {
+            gtfsReport = importGtfs(gtfsDirectory);
+        } else {
+            // Initialize with some demo data
+            stations.insertOrAssign(1, "Central Station");
+            stations.insertOrAssign(2, "North Terminal");
+            stations.insertOrAssign(3, "South Hub");
+            stations.insertOrAssign(4, "East Junction");
+            stations.insertOrAssign(5, "West Plaza");
+            
+            routes.push_back({1, 2, 5});
+            routes.push_back({1, 3, 7});
+            routes.push_back({1, 4, 3});
+            routes.push_back({1, 5, 4});
+            rebuildGraph();
+        }
+        if (!restored) {
+            vehicles.put(101, "bus", 80);
+            vehicles.put(102, "metro", 600);
+            vehicles.put(103, "tram", 200);
+        }
+        if (!logFile.empty()) replayLog(logFile);
+    }
+
+    // Empty unless the base network came from a GTFS feed
+    const std::string& gtfsLoadReport() const { return gtfsReport; }
+
+    ~EnhancedTransportAPI() {
+        if (hierarchyWorker.joinable()) hierarchyWorker.join();
     }
     
     // Helper to setup CORS
@@ -69,9 +633,9 @@ public:
         server.Post("/api/stations", [this](const httplib::Request& req, httplib::Response& res) {
             try {
                 auto body = json::parse(req.body);
-                int id = body["id"];
+                StationId id = body["id"];
                 string name = body["name"];
-                res.set_content(this->addStation(id, name), "application/json");
+                res.set_content(this->addStation(id, name, positionFromJson(body)), "application/json");
             } catch (const std::exception& e) {
                  res.status = 400;
                  json error = {{"success", false}, {"error", e.what()}};
@@ -84,7 +648,7 @@ public:
         });
 
         server.Delete(R"(/api/stations/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
-             int id = std::stoi(req.matches[1]);
+             StationId id = std::stoll(req.matches[1]);
              res.set_content(this->deleteStation(id), "application/json");
         });
         
@@ -92,26 +656,290 @@ public:
         server.Post("/api/routes", [this](const httplib::Request& req, httplib::Response& res) {
              try {
                 auto body = json::parse(req.body);
-                int src = body["source"];
-                int dest = body["destination"];
-                int weight = body["weight"];
+                StationId src = body["source"];
+                StationId dest = body["destination"];
+                int64_t weight = body["weight"];
                 res.set_content(this->addRoute(src, dest, weight), "application/json");
-             } catch (...) { res.status = 400; }
+             } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+             }
+        });
+
+        server.Delete("/api/routes", [this](const httplib::Request& req, httplib::Response& res) {
+             try {
+                auto body = json::parse(req.body);
+                StationId src = body["source"];
+                StationId dest = body["destination"];
+                res.set_content(this->deleteRoute(src, dest), "application/json");
+             } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+             }
+        });
+
+        // Bulk import: {"stations": [{id, name, lat?, lon?}], "routes": [{source, destination, weight}]}.
+        // Send it as application/json: httplib caps form-encoded bodies at 8 KB.
+        server.Post("/api/import", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = json::parse(req.body);
+                ImportBatch batch;
+                for (const auto& station : body.value("stations", json::array())) {
+                    batch.stationIds.push_back(station.at("id").get<StationId>());
+                    batch.stationNames.push_back(station.at("name").get<std::string>());
+                    batch.stationLats.push_back(station.value("lat", double(NAN)));
+                    batch.stationLons.push_back(station.value("lon", double(NAN)));
+                }
+                for (const auto& route : body.value("routes", json::array())) {
+                    batch.routeSources.push_back(route.at("source").get<StationId>());
+                    batch.routeDests.push_back(route.at("destination").get<StationId>());
+                    batch.routeWeights.push_back(route.at("weight").get<int64_t>());
+                }
+                res.set_content(this->importNetwork(batch), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        // Save the network to the binary snapshot loaded at the next start
+        server.Post("/api/snapshot", [this](const httplib::Request&, httplib::Response& res) {
+            try {
+                res.set_content(this->writeSnapshot(), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 500;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
         });
 
         // Path finding
         server.Get("/api/shortest-path", [this](const httplib::Request& req, httplib::Response& res) {
-             // simplified
-             int start = std::stoi(req.get_param_value("start"));
-             int end = std::stoi(req.get_param_value("end"));
-             res.set_content(this->findShortestPath(start, end), "application/json");
+             try {
+                StationId start = std::stoll(req.get_param_value("start"));
+                StationId end = std::stoll(req.get_param_value("end"));
+                std::string algorithm = req.has_param("algorithm") ? req.get_param_value("algorithm") : "auto";
+                std::string queue = req.has_param("queue") ? req.get_param_value("queue") : "radix";
+                res.set_content(this->findShortestPath(start, end, algorithm, queue), "application/json");
+             } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+             }
+        });
+        
+        server.Get("/api/isochrone", [this](const httplib::Request& req, httplib::Response& res) {
+             try {
+                StationId start = std::stoll(req.get_param_value("start"));
+                long long budget = std::stoll(req.get_param_value("budget"));
+                res.set_content(this->findIsochrone(start, budget), "application/json");
+             } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+             }
+        });
+
+        server.Post("/api/distance-matrix", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = json::parse(req.body);
+                std::vector<StationId> sources = body.at("sources").get<std::vector<StationId>>();
+                std::vector<StationId> targets = body.at("targets").get<std::vector<StationId>>();
+                res.set_content(this->computeDistanceMatrix(sources, targets), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        server.Get("/api/landmarks", [this](const httplib::Request& req, httplib::Response& res) {
+             res.set_content(this->getLandmarks(), "application/json");
+        });
+
+        server.Post("/api/landmarks", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = json::parse(req.body);
+                int count = body.value("count", 0); // 0 / "" keep the current setting
+                string selection = body.value("selection", "");
+                res.set_content(this->configureLandmarks(count, selection), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
         });
         
         server.Get(R"(/api/bfs/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
-             int id = std::stoi(req.matches[1]);
+             StationId id = std::stoll(req.matches[1]);
              res.set_content(this->performBFS(id), "application/json");
         });
 
+        server.Get(R"(/api/dfs/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
+             StationId id = std::stoll(req.matches[1]);
+             res.set_content(this->performDFS(id), "application/json");
+        });
+
+        // Passenger queue
+        server.Post("/api/passengers", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = json::parse(req.body);
+                res.set_content(this->addPassenger(passengerFromJson(body)), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        // Board a group in one request: the body is {"passengers": [...]}
+        server.Post("/api/passengers/batch", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = json::parse(req.body);
+                std::vector<PriorityPassengerQueue::Passenger> batch;
+                for (const auto& passenger : body.at("passengers")) batch.push_back(passengerFromJson(passenger));
+                res.set_content(this->addPassengers(batch), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        server.Delete("/api/passengers", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                if (req.has_param("count")) {
+                    long count = std::stol(req.get_param_value("count"));
+                    if (count < 1) throw std::invalid_argument("count must be positive");
+                    res.set_content(this->processPassengers(static_cast<size_t>(count)), "application/json");
+                    return;
+                }
+                res.set_content(this->processPassenger(), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        server.Get("/api/passengers", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                size_t limit = req.has_param("limit") ? std::stoul(req.get_param_value("limit")) : 100;
+                res.set_content(this->getPassengerQueue(limit), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        // Vehicle management
+        server.Post("/api/vehicles", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = json::parse(req.body);
+                int id = body["id"];
+                std::string type = body["type"];
+                uint32_t capacity = body.value("capacity", 0u);
+                res.set_content(this->addVehicle(id, type, capacity), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        // Batched position/status reports, applied asynchronously
+        server.Post("/api/vehicles/telemetry", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                res.set_content(this->ingestTelemetry(req.body), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        // Optional filters: type, status, station
+        server.Get("/api/vehicles", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                VehicleTable::Filter filter;
+                if (req.has_param("type")) filter.type = req.get_param_value("type");
+                if (req.has_param("status")) filter.status = req.get_param_value("status");
+                if (req.has_param("station")) filter.station = std::stoll(req.get_param_value("station"));
+                res.set_content(this->getVehicles(filter), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        server.Get(R"(/api/vehicles/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
+             int id = std::stoi(req.matches[1]);
+             res.set_content(this->searchVehicle(id), "application/json");
+        });
+
+        server.Delete(R"(/api/vehicles/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
+             int id = std::stoi(req.matches[1]);
+             res.set_content(this->removeVehicle(id), "application/json");
+        });
+
+        // Stations and vehicles around lat/lon: all within `radius` meters,
+        // or the `k` closest (no farther than `radius` when both are given).
+        // `kind` narrows the answer to "stations" or "vehicles".
+        server.Get("/api/nearby", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                if (!req.has_param("lat") || !req.has_param("lon")) throw std::invalid_argument("lat and lon are required");
+                GeoPoint center{std::stod(req.get_param_value("lat")), std::stod(req.get_param_value("lon"))};
+                checkPosition(center);
+                std::optional<double> radius;
+                std::optional<size_t> k;
+                if (req.has_param("radius")) {
+                    radius = std::stod(req.get_param_value("radius"));
+                    if (!(*radius >= 0)) throw std::invalid_argument("radius must not be negative");
+                }
+                if (req.has_param("k")) {
+                    long count = std::stol(req.get_param_value("k"));
+                    if (count < 1) throw std::invalid_argument("k must be positive");
+                    k = static_cast<size_t>(count);
+                }
+                if (!radius && !k) throw std::invalid_argument("radius or k is required");
+                std::string kind = req.has_param("kind") ? req.get_param_value("kind") : "all";
+                res.set_content(this->findNearby(center, radius, k, kind), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        // Analytics
+        server.Post("/api/analytics/visit", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = json::parse(req.body);
+                StationId id = body.at("stationId");
+                res.set_content(this->recordStationVisit(id), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
+        server.Get("/api/analytics/stations", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                size_t limit = req.has_param("limit") ? std::stoul(req.get_param_value("limit")) : 100;
+                res.set_content(this->getStationAnalytics(limit), "application/json");
+            } catch (const std::exception& e) {
+                 res.status = 400;
+                 json error = {{"success", false}, {"error", e.what()}};
+                 res.set_content(error.dump(), "application/json");
+            }
+        });
+
         server.Get("/api/status", [this](const httplib::Request& req, httplib::Response& res) {
              res.set_content(this->getSystemStatus(), "application/json");
         });
@@ -120,63 +948,820 @@ public:
     }
     
     // Station operations
-    std::string addStation(int id, const std::string& name) {
-        stations[id] = name;
+    // Renames only touch the station's shard and are logged under its lock,
+    // so the log sees concurrent renames in the order they were applied. A
+    // new id is logged before it is inserted: until then no rename can reach
+    // it, and it can only be inserted under writeMutex. A position replaces
+    // the station's coordinates; without one they are kept.
+    std::string addStation(StationId id, const std::string& name, std::optional<GeoPoint> position = std::nullopt) {
+        uint64_t sequence = 0;
+        auto record = [&]() -> LogWriter {
+            if (!position) return LogWriter(STATION_PUT).i64(id).str(name);
+            return LogWriter(STATION_PUT_AT).i64(id).str(name).f64(position->lat).f64(position->lon);
+        };
+        auto rename = [&](std::string& current) {
+            current = name;
+            if (position) placeStation(id, *position);
+            sequence = wal.append(record());
+        };
+        std::shared_lock<std::shared_mutex> checkpoint(checkpointMutex);
+        if (!stations.update(id, rename)) {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            if (!stations.update(id, rename)) {
+                sequence = wal.append(record());
+                stations.insertOrAssign(id, name);
+                if (position) placeStation(id, *position);
+                stationsChanged();
+            }
+        }
+        checkpoint.unlock();
+        wal.waitDurable(sequence);
         return "{\"success\": true, \"message\": \"Station added successfully\"}";
     }
     
     std::string getStations() {
         json j_stations = json::array();
-        for (const auto& station : stations) {
-            j_stations.push_back({{"id", station.first}, {"name", station.second}});
+        for (const auto& station : stations.snapshot()) {
+            json entry = {{"id", station.first}, {"name", station.second}, {"lat", nullptr}, {"lon", nullptr}};
+            GeoPoint position;
+            if (stationPositions.get(station.first, position)) {
+                entry["lat"] = position.lat;
+                entry["lon"] = position.lon;
+            }
+            j_stations.push_back(entry);
         }
         json response = {{"success", true}, {"stations", j_stations}};
         return response.dump();
     }
     
-    std::string deleteStation(int id) {
+    std::string deleteStation(StationId id) {
+        std::unique_lock<std::mutex> lock(writeMutex);
         stations.erase(id);
+        unplaceStation(id);
+        routes.erase(std::remove_if(routes.begin(), routes.end(), [id](const auto& route) {
+            return std::get<0>(route) == id || std::get<1>(route) == id;
+        }), routes.end());
+        stationsChanged();
+        uint64_t sequence = wal.append(LogWriter(STATION_DELETE).i64(id));
+        lock.unlock();
+        wal.waitDurable(sequence);
         return "{\"success\": true, \"message\": \"Station deleted successfully\"}";
     }
     
     // Route operations
-    std::string addRoute(int source, int dest, int weight) {
-        routes.push_back({source, dest, weight});
+    // Routes are bidirectional; re-adding an existing pair updates its weight
+    // Throws std::invalid_argument for a route validateImport would reject
+    std::string addRoute(StationId source, StationId dest, int64_t requested) {
+        std::unique_lock<std::mutex> lock(writeMutex);
+        std::shared_ptr<const GraphSnapshot> before = routing.pin(), after;
+        const RoutingGraph& graph = before->graph;
+        auto known = [&](StationId id) { return graph.indexOf(id) != RoutingGraph::NONE; };
+        if (const char* issue = routeIssue(source, dest, requested, known)) throw std::invalid_argument(issue);
+        int weight = static_cast<int>(requested);
+        auto existing = findRoute(source, dest);
+        int64_t previous = RoutingGraph::INF;
+        if (existing != routes.end()) {
+            previous = std::get<2>(*existing);
+            std::get<2>(*existing) = weight;
+            // Same stations and arcs: copy the graph and patch the weight
+            auto next = std::make_shared<GraphSnapshot>(*before);
+            if (next->graph.patchWeight(source, dest, weight)) {
+                after = publishGraph(next);
+                // Landmark lower bounds stay admissible when a route only slows down
+                std::lock_guard<std::mutex> guard(landmarkMutex);
+                if (weight >= previous && landmarks && landmarkVersion == before->epoch) {
+                    landmarkVersion = after->epoch;
+                }
+            } else {
+                after = rebuildGraph();
+            }
+        } else {
+            routes.push_back({source, dest, weight});
+            after = rebuildGraph();
+        }
+        repairHotTrees(*before, *after, source, dest, previous, weight);
+        uint64_t sequence = wal.append(LogWriter(ROUTE_PUT).i64(source).i64(dest).i64(weight));
+        lock.unlock();
+        wal.waitDurable(sequence);
         return "{\"success\": true, \"message\": \"Route added successfully\"}";
     }
+
+    std::string deleteRoute(StationId source, StationId dest) {
+        std::unique_lock<std::mutex> lock(writeMutex);
+        auto existing = findRoute(source, dest);
+        if (existing == routes.end()) {
+            json error = {{"success", false}, {"error", "Route not found"}};
+            return error.dump();
+        }
+        int64_t previous = std::get<2>(*existing);
+        routes.erase(existing);
+        std::shared_ptr<const GraphSnapshot> before = routing.pin();
+        std::shared_ptr<const GraphSnapshot> after = rebuildGraph();
+        repairHotTrees(*before, *after, source, dest, previous, RoutingGraph::INF);
+        uint64_t sequence = wal.append(LogWriter(ROUTE_DELETE).i64(source).i64(dest));
+        lock.unlock();
+        wal.waitDurable(sequence);
+        return "{\"success\": true, \"message\": \"Route deleted successfully\"}";
+    }
+
+    // All-or-nothing merge of a validated batch followed by a single graph
+    // rebuild. Existing stations are renamed and existing routes reweighted.
+    // `logged` is false only for a base network loaded before log replay.
+    std::string importNetwork(const ImportBatch& batch, bool logged = true) {
+        std::unique_lock<std::mutex> lock(writeMutex);
+        std::vector<ImportIssue> issues = validateImport(batch, routing.pin()->graph);
+        if (!issues.empty()) {
+            json invalid = json::array();
+            for (const auto& issue : issues) {
+                invalid.push_back({{"kind", issue.kind}, {"index", issue.index}, {"reason", issue.reason}});
+            }
+            json error = {{"success", false}, {"error", "Import rejected"}, {"invalid", invalid}};
+            return error.dump();
+        }
+
+        size_t stationsAdded = 0;
+        for (size_t i = 0; i < batch.stationIds.size(); ++i) {
+            if (stations.insertOrAssign(batch.stationIds[i], batch.stationNames[i])) ++stationsAdded;
+        }
+        for (size_t i = 0; i < batch.stationLats.size(); ++i) {
+            if (std::isnan(batch.stationLats[i])) continue;
+            placeStation(batch.stationIds[i], {batch.stationLats[i], batch.stationLons[i]});
+        }
+
+        std::unordered_map<std::pair<StationId, StationId>, size_t, RoutePairHash> position;
+        position.reserve(routes.size() + batch.routeSources.size());
+        for (size_t i = 0; i < routes.size(); ++i) {
+            position[routePair(std::get<0>(routes[i]), std::get<1>(routes[i]))] = i;
+        }
+        size_t routesAdded = 0;
+        for (size_t i = 0; i < batch.routeSources.size(); ++i) {
+            int weight = static_cast<int>(batch.routeWeights[i]);
+            auto [it, inserted] = position.try_emplace(routePair(batch.routeSources[i], batch.routeDests[i]), routes.size());
+            if (inserted) {
+                routes.push_back({batch.routeSources[i], batch.routeDests[i], weight});
+                ++routesAdded;
+            } else {
+                std::get<2>(routes[it->second]) = weight;
+            }
+        }
+
+        if (stationsAdded) hotTrees.clear();
+        std::shared_ptr<const GraphSnapshot> after = rebuildGraph();
+        uint64_t sequence = 0;
+        if (logged) {
+            bool placed = !batch.stationLats.empty();
+            LogWriter record(placed ? IMPORT_AT : IMPORT);
+            record.i64(static_cast<int64_t>(batch.stationIds.size()));
+            for (size_t i = 0; i < batch.stationIds.size(); ++i) {
+                record.i64(batch.stationIds[i]).str(batch.stationNames[i]);
+                if (placed) record.f64(batch.stationLats[i]).f64(batch.stationLons[i]);
+            }
+            record.i64(static_cast<int64_t>(batch.routeSources.size()));
+            for (size_t i = 0; i < batch.routeSources.size(); ++i) {
+                record.i64(batch.routeSources[i]).i64(batch.routeDests[i]).i64(batch.routeWeights[i]);
+            }
+            sequence = wal.append(record);
+        }
+        lock.unlock();
+        wal.waitDurable(sequence);
+        json response = {
+            {"success", true},
+            {"stationsAdded", stationsAdded},
+            {"stationsUpdated", batch.stationIds.size() - stationsAdded},
+            {"routesAdded", routesAdded},
+            {"routesUpdated", batch.routeSources.size() - routesAdded},
+            {"stationCount", after->graph.nodeCount()},
+            {"arcCount", after->graph.arcCount()}
+        };
+        return response.dump();
+    }
+
+    // Save the current network, plus the hierarchy and landmarks if they
+    // match it, to the snapshot file
+    std::string writeSnapshot() {
+        if (snapshotPath.empty()) {
+            return "{\"success\": false, \"error\": \"No snapshot file configured\"}";
+        }
+        auto started = std::chrono::steady_clock::now();
+        // Holding out every writer keeps station names in step with the
+        // pinned graph and the log empty of anything the snapshot lacks
+        std::unique_lock<std::shared_mutex> checkpoint(checkpointMutex);
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::shared_ptr<const GraphSnapshot> snapshot = routing.pin();
+        const RoutingGraph& graph = snapshot->graph;
+        std::vector<std::string> names(graph.nodeCount());
+        for (uint32_t node = 0; node < graph.nodeCount(); ++node) names[node] = stationName(graph.stationAt(node));
+        std::vector<GeoPoint> positions;
+        if (stationPositions.size()) {
+            positions.assign(graph.nodeCount(), GeoPoint{NAN, NAN});
+            for (uint32_t node = 0; node < graph.nodeCount(); ++node) {
+                stationPositions.get(graph.stationAt(node), positions[node]);
+            }
+        }
+        std::shared_ptr<const ContractionHierarchy> ch;
+        {
+            std::lock_guard<std::mutex> hierarchyLock(hierarchyMutex);
+            if (hierarchy && hierarchy->version() == snapshot->epoch) ch = hierarchy;
+        }
+        std::shared_ptr<const LandmarkIndex> alt;
+        {
+            std::lock_guard<std::mutex> landmarkLock(landmarkMutex);
+            if (landmarks && landmarkVersion == snapshot->epoch) alt = landmarks;
+        }
+        // write() returns once the file and its directory entry are on disk
+        // and throws otherwise, so the log is never truncated ahead of them
+        uint64_t bytes = NetworkSnapshot::write(snapshotPath, graph, names, positions, ch.get(), alt.get());
+        wal.checkpoint();
+        // The snapshot holds only the network; carry the queue and the fleet
+        // into the new log. Reports already logged are applied first, since
+        // their records were just truncated.
+        std::vector<PriorityPassengerQueue::Passenger> queued = passengers.peek(SIZE_MAX);
+        uint64_t sequence = queued.empty() ? 0 : wal.append(enqueueBatchRecord(queued));
+        telemetry.flush();
+        std::vector<VehicleTable::Vehicle> fleet = vehicles.select({});
+        std::vector<VehicleUpdate> reports;
+        for (const auto& vehicle : fleet) {
+            sequence = wal.append(LogWriter(VEHICLE_PUT).i64(vehicle.id).str(vehicle.type).i64(vehicle.capacity));
+            if (vehicle.updated == 0) continue;
+            uint8_t status = vehicles.statusCode(vehicle.status).value_or(VehicleTable::UNKNOWN_STATUS);
+            VehicleUpdate report{vehicle.id, VehicleUpdate::STATUS, status, vehicle.station,
+                                 vehicle.lat, vehicle.lon, vehicle.updated};
+            if (vehicle.station != VehicleTable::NO_STATION) report.fields |= VehicleUpdate::STATION;
+            if (!std::isnan(vehicle.lat)) report.fields |= VehicleUpdate::POSITION;
+            reports.push_back(report);
+        }
+        if (!reports.empty()) sequence = wal.append(telemetryRecord(reports));
+        wal.waitDurable(sequence);
+        json response = {
+            {"success", true},
+            {"path", snapshotPath},
+            {"bytes", bytes},
+            {"stationCount", graph.nodeCount()},
+            {"arcCount", graph.arcCount()},
+            {"hierarchy", ch != nullptr},
+            {"landmarks", alt != nullptr},
+            {"ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count()}
+        };
+        return response.dump();
+    }
+
+    // Load a GTFS feed as the base network through the import path, so the
+    // whole network costs one rebuild. The feed is read again on every start
+    // without a snapshot, so it is not logged: the log only holds the edits
+    // made on top of it.
+    std::string importGtfs(const std::string& directory) {
+        GtfsNetwork network = GtfsLoader::load(directory);
+        ImportBatch batch;
+        batch.stationIds = std::move(network.stationIds);
+        batch.stationNames = std::move(network.stationNames);
+        batch.stationLats = std::move(network.stationLats);
+        batch.stationLons = std::move(network.stationLons);
+        for (const auto& [source, dest, weight] : network.routes) {
+            batch.routeSources.push_back(source);
+            batch.routeDests.push_back(dest);
+            batch.routeWeights.push_back(weight);
+        }
+        json result = json::parse(importNetwork(batch, false));
+        if (!result["success"].get<bool>()) throw std::runtime_error("GTFS feed rejected: " + result.dump());
+        result["trips"] = network.trips;
+        result["stopTimes"] = network.stopTimes;
+        result["skippedRows"] = network.skippedRows;
+        result["skippedStops"] = network.skippedStops;
+        return result.dump();
+    }
+
+    std::vector<RoutingGraph::Route>::iterator findRoute(StationId source, StationId dest) {
+        return std::find_if(routes.begin(), routes.end(), [&](const auto& route) {
+            return (std::get<0>(route) == source && std::get<1>(route) == dest) ||
+                   (std::get<0>(route) == dest && std::get<1>(route) == source);
+        });
+    }
     
-    // Path finding (simplified Dijkstra simulation)
-    std::string findShortestPath(int start, int end) {
-        std::string startName = stations.count(start) ? stations[start] : "Unknown";
-        std::string endName = stations.count(end) ? stations[end] : "Unknown";
+    // Path finding over the CSR store. "auto" reads the answer off a hot
+    // origin's shortest-path tree when there is one, then uses the
+    // contraction hierarchy when one is ready for the current graph, then ALT
+    // if its landmarks are still valid, and falls back to Dijkstra on the
+    // selected priority queue.
+    std::string findShortestPath(StationId start, StationId end, const std::string& algorithm = "auto",
+                                 const std::string& queue = "radix") {
+        if (algorithm != "auto" && algorithm != "dijkstra" && algorithm != "ch" && algorithm != "alt") {
+            json error = {{"success", false}, {"error", "Unknown algorithm: " + algorithm}};
+            return error.dump();
+        }
+        QueueKind queueKind;
+        if (!parseQueueKind(queue, queueKind)) {
+            json error = {{"success", false}, {"error", "Unknown queue: " + queue}};
+            return error.dump();
+        }
+        std::shared_ptr<const GraphSnapshot> snapshot = routing.pin();
+        const RoutingGraph& g = snapshot->graph;
+        if (g.indexOf(start) == RoutingGraph::NONE || g.indexOf(end) == RoutingGraph::NONE) {
+            json error = {{"success", false}, {"error", "Unknown station"}};
+            return error.dump();
+        }
+
+        // Only Dijkstra-style queries make an origin hot; its tree answers "auto"
+        std::shared_ptr<const ShortestPathTree> tree;
+        if (algorithm == "auto" || algorithm == "dijkstra") tree = hotTrees.touch(g, snapshot->epoch, start);
+        PathCacheKey key{start, end, algorithm + "/" + queueKindName(queueKind), snapshot->epoch};
+        CachedPath cached;
+        bool hit = pathCache.get(key, cached);
+        if (!hit && tree && algorithm == "auto") {
+            cached = {tree->pathTo(g, g.indexOf(end)), "spt"};
+        } else if (!hit) {
+            cached = computePath(snapshot, start, end, algorithm, queueKind);
+            pathCache.put(key, cached);
+        }
+
+        const RoutingGraph::PathResult& result = cached.result;
+        if (!result.found) {
+            json error = {{"success", false}, {"error", "No path between stations"}};
+            return error.dump();
+        }
 
         json path = json::array();
-        path.push_back({{"id", start}, {"name", startName}});
-        path.push_back({{"id", 1}, {"name", "Central Station"}}); // Dummy waypoint
-        path.push_back({{"id", end}, {"name", endName}});
+        for (StationId id : result.path) {
+            path.push_back({{"id", id}, {"name", stationName(id)}});
+        }
 
         json response = {
             {"success", true},
             {"path", path},
-            {"distance", 5 + rand() % 15}
+            {"distance", result.distance},
+            {"algorithm", cached.algorithm},
+            {"cached", hit}
+        };
+        return response.dump();
+    }
+
+    CachedPath computePath(const std::shared_ptr<const GraphSnapshot>& snapshot, StationId start, StationId end,
+                           const std::string& algorithm, QueueKind queue) {
+        const RoutingGraph& g = snapshot->graph;
+        CachedPath computed{{}, "dijkstra"};
+        std::shared_ptr<const ContractionHierarchy> ch;
+        if (algorithm == "auto" || algorithm == "ch") ch = currentHierarchy(snapshot);
+        if (ch) {
+            computed.result = ch->query(g.indexOf(start), g.indexOf(end));
+            computed.algorithm = "ch";
+        } else if (algorithm == "alt" || (algorithm == "auto" && landmarksCurrent(snapshot->epoch))) {
+            computed.result = currentLandmarks(*snapshot)->query(g, g.indexOf(start), g.indexOf(end));
+            computed.algorithm = "alt";
+        } else {
+            computed.result = g.dijkstra(start, end, queue);
+        }
+        return computed;
+    }
+    
+    // Stations reachable from `start` within `budget`, nearest first
+    std::string findIsochrone(StationId start, long long budget) {
+        std::shared_ptr<const GraphSnapshot> snapshot = routing.pin();
+        const RoutingGraph& g = snapshot->graph;
+        uint32_t source = g.indexOf(start);
+        if (source == RoutingGraph::NONE || budget < 0) {
+            json error = {{"success", false}, {"error", source == RoutingGraph::NONE ? "Unknown station" : "Budget must be non-negative"}};
+            return error.dump();
+        }
+
+        json reachable = json::array();
+        for (const auto& [node, dist] : Isochrone::reachable(g, source, budget)) {
+            StationId id = g.stationAt(node);
+            reachable.push_back({{"id", id}, {"name", stationName(id)}, {"distance", dist}});
+        }
+        json response = {
+            {"success", true},
+            {"start", start},
+            {"budget", budget},
+            {"stations", reachable}
+        };
+        return response.dump();
+    }
+
+    // Many-to-many distances: CH buckets when a hierarchy is ready, otherwise
+    // one Dijkstra per source spread across cores
+    std::string computeDistanceMatrix(const std::vector<StationId>& sources, const std::vector<StationId>& targets) {
+        static const size_t MAX_CELLS = 4'000'000;
+        if (sources.size() * targets.size() > MAX_CELLS) {
+            json error = {{"success", false}, {"error", "Matrix too large"}};
+            return error.dump();
+        }
+
+        std::shared_ptr<const GraphSnapshot> snapshot = routing.pin();
+        const RoutingGraph& g = snapshot->graph;
+        StationId unknown = 0;
+        auto toNodes = [&](const std::vector<StationId>& ids, std::vector<uint32_t>& nodes) {
+            for (StationId id : ids) {
+                uint32_t node = g.indexOf(id);
+                if (node == RoutingGraph::NONE) { unknown = id; return false; }
+                nodes.push_back(node);
+            }
+            return true;
+        };
+        std::vector<uint32_t> sourceNodes, targetNodes;
+        if (!toNodes(sources, sourceNodes) || !toNodes(targets, targetNodes)) {
+            json error = {{"success", false}, {"error", "Unknown station: " + std::to_string(unknown)}};
+            return error.dump();
+        }
+
+        std::string used = "dijkstra";
+        DistanceMatrix::Matrix matrix;
+        if (auto ch = currentHierarchy(snapshot)) {
+            matrix = DistanceMatrix::withHierarchy(*ch, sourceNodes, targetNodes);
+            used = "ch";
+        } else {
+            matrix = DistanceMatrix::withDijkstra(g, sourceNodes, targetNodes);
+        }
+
+        json distances = json::array();
+        for (const auto& row : matrix) {
+            json cells = json::array();
+            for (int64_t d : row) {
+                if (d == RoutingGraph::INF) cells.push_back(nullptr);
+                else cells.push_back(d);
+            }
+            distances.push_back(cells);
+        }
+        json response = {
+            {"success", true},
+            {"sources", sources},
+            {"targets", targets},
+            {"distances", distances},
+            {"algorithm", used}
+        };
+        return response.dump();
+    }
+
+    // Landmark configuration
+    std::string getLandmarks() {
+        std::lock_guard<std::mutex> lock(landmarkMutex);
+        return landmarksResponse();
+    }
+
+    std::string configureLandmarks(int count, const std::string& selection) {
+        std::lock_guard<std::mutex> lock(landmarkMutex);
+        LandmarkIndex::Selection mode = landmarkSelection;
+        if (count == 0) count = static_cast<int>(landmarkTarget);
+        if (count < 1 || count > 64 || (!selection.empty() && !LandmarkIndex::parseSelection(selection, mode))) {
+            json error = {{"success", false}, {"error", "Expected 1-64 landmarks with selection 'farthest' or 'avoid'"}};
+            return error.dump();
+        }
+        landmarkTarget = static_cast<uint32_t>(count);
+        landmarkSelection = mode;
+        std::shared_ptr<const GraphSnapshot> snapshot = routing.pin();
+        auto fresh = std::make_shared<LandmarkIndex>(landmarkTarget, landmarkSelection);
+        fresh->refresh(snapshot->graph);
+        landmarks = fresh;
+        landmarkVersion = snapshot->epoch;
+        return landmarksResponse();
+    }
+
+    // Caller holds landmarkMutex
+    std::string landmarksResponse() {
+        bool ready = landmarks && landmarkVersion == routing.pin()->epoch;
+        json response = {
+            {"success", true},
+            {"landmarks", {
+                {"count", landmarkTarget},
+                {"selection", LandmarkIndex::selectionName(landmarkSelection)},
+                {"stations", landmarks ? landmarks->landmarkStations() : std::vector<StationId>()},
+                {"state", ready ? "ready" : "stale"}
+            }}
         };
         return response.dump();
     }
     
     // BFS traversal
-    std::string performBFS(int startId) {
-        json traversal = {1, 2, 3, 4, 5};
+    std::string performBFS(StationId startId) {
+        return traversalResponse(startId, GraphTraversal::bfs);
+    }
+
+    // DFS traversal
+    std::string performDFS(StationId startId) {
+        return traversalResponse(startId, GraphTraversal::dfs);
+    }
+
+    std::string traversalResponse(StationId startId,
+                                  std::vector<uint32_t> (*traverse)(const RoutingGraph&, uint32_t)) {
+        std::shared_ptr<const GraphSnapshot> snapshot = routing.pin();
+        const RoutingGraph& g = snapshot->graph;
+        uint32_t start = g.indexOf(startId);
+        if (start == RoutingGraph::NONE) {
+            json error = {{"success", false}, {"error", "Unknown station"}};
+            return error.dump();
+        }
+        json traversal = json::array();
+        for (uint32_t node : traverse(g, start)) traversal.push_back(g.stationAt(node));
         json response = {{"success", true}, {"traversal", traversal}};
         return response.dump();
     }
     
+    json pathCacheStats() {
+        PathCache::Stats stats = pathCache.stats();
+        return {{"entries", stats.entries}, {"hits", stats.hits}, {"misses", stats.misses}};
+    }
+
+    // Passenger operations
+    static PriorityPassengerQueue::Passenger passengerFromJson(const json& body) {
+        PriorityPassengerQueue::Passenger passenger;
+        passenger.id = body.at("id").get<int>();
+        passenger.name = body.at("name").get<std::string>();
+        if (!PriorityPassengerQueue::parseClass(body.value("class", std::string()), passenger.priority)) {
+            throw std::invalid_argument("class must be accessibility, staff or regular");
+        }
+        passenger.deadline = body.contains("deadline") && !body["deadline"].is_null()
+            ? body["deadline"].get<int64_t>() : PriorityPassengerQueue::NO_DEADLINE;
+        return passenger;
+    }
+
+    static void logPassenger(LogWriter& record, const PriorityPassengerQueue::Passenger& passenger) {
+        record.i64(passenger.id).str(passenger.name).i64(static_cast<int64_t>(passenger.priority)).i64(passenger.deadline);
+    }
+
+    static LogWriter enqueueBatchRecord(const std::vector<PriorityPassengerQueue::Passenger>& batch) {
+        LogWriter record(PASSENGER_ENQUEUE_BATCH);
+        record.i64(static_cast<int64_t>(batch.size()));
+        for (const auto& passenger : batch) logPassenger(record, passenger);
+        return record;
+    }
+
+    static json passengerJson(const PriorityPassengerQueue::Passenger& passenger) {
+        json out = {
+            {"id", passenger.id},
+            {"name", passenger.name},
+            {"class", PriorityPassengerQueue::className(passenger.priority)},
+            {"deadline", nullptr}
+        };
+        if (passenger.deadline != PriorityPassengerQueue::NO_DEADLINE) out["deadline"] = passenger.deadline;
+        return out;
+    }
+
+    std::string addPassenger(const PriorityPassengerQueue::Passenger& passenger) {
+        std::shared_lock<std::shared_mutex> checkpoint(checkpointMutex);
+        passengers.enqueue(passenger.id, passenger.name, passenger.priority, passenger.deadline);
+        LogWriter record(PASSENGER_ENQUEUE);
+        logPassenger(record, passenger);
+        uint64_t sequence = wal.append(record);
+        checkpoint.unlock();
+        wal.waitDurable(sequence);
+        return "{\"success\": true, \"message\": \"Passenger added to queue\"}";
+    }
+
+    // One queue lock, one log record and one fsync wait for the whole group
+    std::string addPassengers(const std::vector<PriorityPassengerQueue::Passenger>& batch) {
+        std::shared_lock<std::shared_mutex> checkpoint(checkpointMutex);
+        passengers.enqueueBatch(batch);
+        uint64_t sequence = batch.empty() ? 0 : wal.append(enqueueBatchRecord(batch));
+        checkpoint.unlock();
+        wal.waitDurable(sequence);
+        json response = {{"success", true}, {"added", batch.size()}, {"queueLength", passengers.size()}};
+        return response.dump();
+    }
+
+    std::string processPassenger() {
+        std::shared_lock<std::shared_mutex> checkpoint(checkpointMutex);
+        std::optional<PriorityPassengerQueue::Passenger> passenger = passengers.dequeue();
+        if (!passenger) {
+            json error = {{"success", false}, {"error", "No passengers in queue"}};
+            return error.dump();
+        }
+        uint64_t sequence = wal.append(LogWriter(PASSENGER_DEQUEUE).i64(passenger->id));
+        checkpoint.unlock();
+        wal.waitDurable(sequence);
+        json response = {
+            {"success", true},
+            {"message", "Passenger processed"},
+            {"passenger", passengerJson(*passenger)}
+        };
+        return response.dump();
+    }
+
+    std::string processPassengers(size_t count) {
+        std::shared_lock<std::shared_mutex> checkpoint(checkpointMutex);
+        std::vector<PriorityPassengerQueue::Passenger> served = passengers.dequeueBatch(count);
+        uint64_t sequence = 0;
+        if (!served.empty()) {
+            LogWriter record(PASSENGER_DEQUEUE_BATCH);
+            record.i64(static_cast<int64_t>(served.size()));
+            for (const auto& passenger : served) record.i64(passenger.id);
+            sequence = wal.append(record);
+        }
+        checkpoint.unlock();
+        wal.waitDurable(sequence);
+        json list = json::array();
+        for (const auto& passenger : served) list.push_back(passengerJson(passenger));
+        json response = {
+            {"success", true},
+            {"count", served.size()},
+            {"passengers", list},
+            {"queueLength", passengers.size()}
+        };
+        return response.dump();
+    }
+
+    std::string getPassengerQueue(size_t limit) {
+        json queue = json::array();
+        for (const auto& passenger : passengers.peek(limit)) {
+            queue.push_back(passengerJson(passenger));
+        }
+        json response = {{"success", true}, {"queue", queue}, {"queueLength", passengers.size()}};
+        return response.dump();
+    }
+
+    LogWriter telemetryRecord(const std::vector<VehicleUpdate>& updates) {
+        LogWriter record(VEHICLE_TELEMETRY);
+        record.i64(static_cast<int64_t>(updates.size()));
+        for (const VehicleUpdate& update : updates) {
+            record.i64(update.vehicle).i64(update.fields).str(vehicles.statusName(update.status));
+            record.i64(update.station).f64(update.lat).f64(update.lon).i64(update.timestamp);
+        }
+        return record;
+    }
+
+    // Vehicle operations
+    std::string addVehicle(int id, const std::string& type, uint32_t capacity) {
+        std::shared_lock<std::shared_mutex> checkpoint(checkpointMutex);
+        vehicles.put(id, type, capacity);
+        uint64_t sequence = wal.append(LogWriter(VEHICLE_PUT).i64(id).str(type).i64(capacity));
+        checkpoint.unlock();
+        wal.waitDurable(sequence);
+        return "{\"success\": true, \"message\": \"Vehicle added successfully\"}";
+    }
+
+    static json vehicleJson(const VehicleTable::Vehicle& vehicle) {
+        json out = {
+            {"id", vehicle.id},
+            {"type", vehicle.type},
+            {"status", vehicle.status},
+            {"station", nullptr},
+            {"capacity", vehicle.capacity},
+            {"lat", nullptr},
+            {"lon", nullptr},
+            {"updated", vehicle.updated}
+        };
+        if (vehicle.station != VehicleTable::NO_STATION) out["station"] = vehicle.station;
+        if (!std::isnan(vehicle.lat)) {
+            out["lat"] = vehicle.lat;
+            out["lon"] = vehicle.lon;
+        }
+        return out;
+    }
+
+    // Parsed without a DOM, logged, and handed to the ingest rings; the fleet
+    // table shows the reports once the background stage has applied them.
+    // Replay applies the logged batches in log order, and stale reports lose
+    // to newer ones by timestamp either way.
+    std::string ingestTelemetry(const std::string& body) {
+        int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::vector<VehicleUpdate> updates;
+        TelemetryReader reader(vehicles, now, updates);
+        if (!json::sax_parse(body, &reader)) throw std::invalid_argument(reader.error());
+        std::shared_lock<std::shared_mutex> checkpoint(checkpointMutex);
+        uint64_t sequence = updates.empty() ? 0 : wal.append(telemetryRecord(updates));
+        telemetry.submit(updates.data(), updates.size());
+        checkpoint.unlock();
+        wal.waitDurable(sequence);
+        unknownStatuses.fetch_add(reader.unknownStatuses(), std::memory_order_relaxed);
+        json response = {{"success", true}, {"accepted", updates.size()}, {"unknownStatus", reader.unknownStatuses()}};
+        return response.dump();
+    }
+
+    std::string getVehicles(const VehicleTable::Filter& filter) {
+        json list = json::array();
+        for (const auto& vehicle : vehicles.select(filter)) list.push_back(vehicleJson(vehicle));
+        json response = {{"success", true}, {"vehicles", list}};
+        return response.dump();
+    }
+
+    std::string searchVehicle(int id) {
+        std::optional<VehicleTable::Vehicle> vehicle = vehicles.get(id);
+        if (!vehicle) {
+            json error = {{"success", false}, {"error", "Vehicle not found"}};
+            return error.dump();
+        }
+        json response = {{"success", true}, {"vehicle", vehicleJson(*vehicle)}};
+        return response.dump();
+    }
+
+    std::string removeVehicle(int id) {
+        std::shared_lock<std::shared_mutex> checkpoint(checkpointMutex);
+        if (!vehicles.erase(id)) {
+            json error = {{"success", false}, {"error", "Vehicle not found"}};
+            return error.dump();
+        }
+        uint64_t sequence = wal.append(LogWriter(VEHICLE_DELETE).i64(id));
+        checkpoint.unlock();
+        wal.waitDurable(sequence);
+        return "{\"success\": true, \"message\": \"Vehicle removed successfully\"}";
+    }
+
+    json telemetryStats() {
+        TelemetryIngest::Stats stats = telemetry.stats();
+        return {{"received", stats.received}, {"applied", stats.applied},
+                {"coalesced", stats.coalesced}, {"unknown", stats.unknown},
+                {"unknownStatus", unknownStatuses.load(std::memory_order_relaxed)}};
+    }
+
+    static void checkPosition(GeoPoint position) {
+        if (!(position.lat >= -90 && position.lat <= 90 && position.lon >= -180 && position.lon <= 180)) {
+            throw std::invalid_argument("lat must be in [-90, 90] and lon in [-180, 180]");
+        }
+    }
+
+    // Optional "lat"/"lon" pair of a request body
+    static std::optional<GeoPoint> positionFromJson(const json& body) {
+        if (!body.contains("lat") && !body.contains("lon")) return std::nullopt;
+        if (!body.contains("lat") || !body.contains("lon")) throw std::invalid_argument("lat and lon go together");
+        GeoPoint position{body.at("lat").get<double>(), body.at("lon").get<double>()};
+        checkPosition(position);
+        return position;
+    }
+
+    std::string findNearby(GeoPoint center, std::optional<double> radius, std::optional<size_t> k,
+                           const std::string& kind) {
+        bool wantStations = kind == "all" || kind == "stations";
+        bool wantVehicles = kind == "all" || kind == "vehicles";
+        if (!wantStations && !wantVehicles) {
+            json error = {{"success", false}, {"error", "Unknown kind: " + kind}};
+            return error.dump();
+        }
+        double maxRadius = radius.value_or(INFINITY);
+        json response = {{"success", true}};
+        if (wantStations) {
+            std::shared_ptr<const StationTree> index = currentStationTree();
+            auto scan = [&](const GeoBox& box, auto visit) {
+                index->tree.search(box, [&](uint32_t i) { visit(i, index->points[i]); });
+            };
+            auto hits = k ? nearestK<uint32_t>(center, *k, maxRadius, scan)
+                          : withinRadius<uint32_t>(center, maxRadius, scan);
+            json list = json::array();
+            for (const auto& [i, meters] : hits) {
+                list.push_back({{"id", index->ids[i]}, {"name", stationName(index->ids[i])},
+                                {"lat", index->points[i].lat}, {"lon", index->points[i].lon}, {"distance", meters}});
+            }
+            response["stations"] = list;
+        }
+        if (wantVehicles) {
+            auto hits = k ? vehicles.nearest(center, *k, maxRadius) : vehicles.within(center, maxRadius);
+            json list = json::array();
+            for (const auto& [vehicle, meters] : hits) {
+                json entry = vehicleJson(vehicle);
+                entry["distance"] = meters;
+                list.push_back(entry);
+            }
+            response["vehicles"] = list;
+        }
+        return response.dump();
+    }
+
     // Analytics
+    // Counted without checking the station exists, which would put a shared
+    // lock on the turnstile path; unknown ids show up with a null name
+    std::string recordStationVisit(StationId id) {
+        visits.record(id);
+        return "{\"success\": true, \"message\": \"Visit recorded\"}";
+    }
+
+    // Busiest stations first, merged from the visit counter shards
+    std::string getStationAnalytics(size_t limit) {
+        std::vector<std::pair<StationId, uint64_t>> totals = visits.totals();
+        json frequencies = json::array();
+        for (size_t i = 0; i < totals.size() && i < limit; ++i) {
+            std::string name;
+            json entry = {{"stationId", totals[i].first}, {"name", nullptr}, {"visits", totals[i].second}};
+            if (stations.get(totals[i].first, name)) entry["name"] = name;
+            frequencies.push_back(entry);
+        }
+        uint64_t total = 0;
+        for (const auto& station : totals) total += station.second;
+        json response = {
+            {"success", true},
+            {"analytics", {
+                {"mostCrowded", frequencies.empty() ? json(nullptr) : frequencies[0]},
+                {"frequencies", frequencies},
+                {"totalVisits", total}
+            }}
+        };
+        return response.dump();
+    }
+
     std::string getSystemStatus() {
+        size_t queueLength = passengers.size();
         json status = {
             {"uptime", "Running"},
             {"stationCount", stations.size()},
-            {"queueLength", passengers.size()},
-            {"vehicleCount", vehicles.size()}
+            {"queueLength", queueLength},
+            {"vehicleCount", vehicles.size()},
+            {"hierarchy", hierarchyState()},
+            {"pathCache", pathCacheStats()},
+            {"hotOrigins", hotTrees.size()},
+            {"wal", {
+                {"enabled", wal.enabled()},
+                {"replayed", replayedRecords},
+                {"records", wal.recordCount()},
+                {"syncs", wal.syncCount()},
+                {"bytes", wal.byteCount()}
+            }},
+            {"telemetry", telemetryStats()}
         };
         json response = {
             {"success", true},
@@ -186,15 +1771,45 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "🚇 Enhanced Transport Network Management System" << std::endl;
     std::cout << "================================================" << std::endl;
     
+    // --snapshot <file> (default network.snapshot), --wal <file> (default
+    // network.wal), --gtfs <directory>
+    std::string snapshotFile = "network.snapshot";
+    std::string logFile = "network.wal";
+    std::string gtfsDirectory;
+    for (int i = 1; i + 1 < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--snapshot") snapshotFile = argv[++i];
+        else if (flag == "--wal") logFile = argv[++i];
+        else if (flag == "--gtfs") gtfsDirectory = argv[++i];
+    }
+    
     httplib::Server server;
-    EnhancedTransportAPI api;
+    std::unique_ptr<EnhancedTransportAPI> api;
+    try {
+        auto started = std::chrono::steady_clock::now();
+        api = std::make_unique<EnhancedTransportAPI>(snapshotFile, logFile, gtfsDirectory);
+        std::cout << "Network ready in "
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count()
+                  << " ms" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: could not restore network: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    if (!gtfsDirectory.empty()) {
+        if (api->gtfsLoadReport().empty()) {
+            std::cout << "GTFS feed in " << gtfsDirectory << " skipped: restored from " << snapshotFile << std::endl;
+        } else {
+            std::cout << "Loaded GTFS feed from " << gtfsDirectory << ": " << api->gtfsLoadReport() << std::endl;
+        }
+    }
     
     // Setup API routes
-    api.setupRoutes(server);
+    api->setupRoutes(server);
     
     std::cout << "\n=== Starting HTTP Server ===" << std::endl;
     std::cout << "🚇 Transport API Server starting on http://localhost:8080" << std::endl;
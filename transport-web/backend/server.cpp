@@ -5,28 +5,62 @@
 #include <chrono>
 #include <functional>
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+#include <algorithm>
 #include "httplib.h"
 #include "json.hpp"
+#include "BulkImport.h"
+#include "RoutingGraph.h"
+#include "Traversal.h"
+#include "PriorityPassengerQueue.h"
+#include "VehicleTable.h"
+#include "VisitCounters.h"
 
 // Include your DSA project headers
 #include "../../DSA_project/src/CityGraph.h"
-#include "../../DSA_project/src/VehicleMap.h"
 #include "../../DSA_project/src/CoreDS.h"
-#include "../../DSA_project/src/Analytics.h"
 #include "../../DSA_project/src/Tree.h"
-#include "../../DSA_project/src/Heap.h"
 
 using json = nlohmann::json;
 using namespace std;
 
 // Global instances
 CityGraph city;
-PassengerQueue pQueue;
-VehicleHashTable vTable;
+PriorityPassengerQueue pQueue; // lock-free arrivals, served by class; replaces the DSA PassengerQueue
+VehicleTable vTable; // Swiss-table fleet map, replaces the DSA VehicleHashTable
 HistoryStack history;
 BST bst;
-MinHeap heap(100);
-Analytics analytics;
+VisitCounters visits; // per-thread turnstile counters, replaces the DSA Analytics
+
+// Mirror of the stations/routes handed to CityGraph, compiled into a CSR
+// graph on demand for path finding and traversals. httplib runs handlers on
+// a thread pool: writers change the mirror under an exclusive lock and drop
+// the compiled graph, readers pin the current one and keep using it after
+// the lock is released, so a rebuild never pulls arrays out from under them.
+std::shared_mutex networkMutex;
+std::map<StationId, std::string> stationNames;
+std::vector<RoutingGraph::Route> routeList;
+std::shared_ptr<const RoutingGraph> routing; // null until rebuilt after a change
+
+std::shared_ptr<const RoutingGraph> routingGraph() {
+    {
+        std::shared_lock<std::shared_mutex> lock(networkMutex);
+        if (routing) return routing;
+    }
+    std::unique_lock<std::shared_mutex> lock(networkMutex);
+    if (!routing) {
+        std::vector<StationId> ids;
+        for (const auto& station : stationNames) ids.push_back(station.first);
+        auto next = std::make_shared<RoutingGraph>();
+        next->build(ids, routeList);
+        routing = std::move(next);
+    }
+    return routing;
+}
 
 class TransportAPI {
 public:
@@ -86,6 +120,11 @@ private:
             
             city.addStation(id, name);
             history.push("ADD_STATION", id);
+            {
+                std::unique_lock<std::shared_mutex> lock(networkMutex);
+                stationNames[id] = name;
+                routing.reset();
+            }
             
             json response = {{"success", true}, {"message", "Station added successfully"}};
             res.set_content(response.dump(), "application/json");
@@ -114,6 +153,14 @@ private:
             int id = stoi(req.matches[1]);
             city.deleteStation(id);
             history.push("DELETE_STATION", id);
+            {
+                std::unique_lock<std::shared_mutex> lock(networkMutex);
+                stationNames.erase(id);
+                routeList.erase(std::remove_if(routeList.begin(), routeList.end(), [id](const auto& route) {
+                    return std::get<0>(route) == id || std::get<1>(route) == id;
+                }), routeList.end());
+                routing.reset();
+            }
             
             json response = {{"success", true}, {"message", "Station deleted successfully"}};
             res.set_content(response.dump(), "application/json");
@@ -129,10 +176,27 @@ private:
             json body = json::parse(req.body);
             int src = body["source"];
             int dest = body["destination"];
-            int weight = body["weight"];
-            
-            city.addRoute(src, dest, weight);
-            history.push("ADD_ROUTE", src);
+            int64_t requested = body["weight"];
+            int weight = static_cast<int>(requested);
+            {
+                // Checked before CityGraph sees it, as the bulk import does; the
+                // mirror follows only once CityGraph has taken the route
+                std::unique_lock<std::shared_mutex> lock(networkMutex);
+                auto known = [](StationId id) { return stationNames.count(id) != 0; };
+                if (const char* issue = routeIssue(src, dest, requested, known)) throw std::invalid_argument(issue);
+
+                city.addRoute(src, dest, weight);
+                history.push("ADD_ROUTE", src);
+
+                // Either orientation names the same route: re-adding one reweights it
+                auto existing = std::find_if(routeList.begin(), routeList.end(), [&](const auto& route) {
+                    return (std::get<0>(route) == src && std::get<1>(route) == dest) ||
+                           (std::get<0>(route) == dest && std::get<1>(route) == src);
+                });
+                if (existing != routeList.end()) std::get<2>(*existing) = weight;
+                else routeList.push_back({src, dest, weight});
+                routing.reset();
+            }
             
             json response = {{"success", true}, {"message", "Route added successfully"}};
             res.set_content(response.dump(), "application/json");
@@ -151,6 +215,14 @@ private:
             
             city.deleteRoute(src, dest);
             history.push("DELETE_ROUTE", src);
+            {
+                std::unique_lock<std::shared_mutex> lock(networkMutex);
+                routeList.erase(std::remove_if(routeList.begin(), routeList.end(), [&](const auto& route) {
+                    return (std::get<0>(route) == src && std::get<1>(route) == dest) ||
+                           (std::get<0>(route) == dest && std::get<1>(route) == src);
+                }), routeList.end());
+                routing.reset();
+            }
             
             json response = {{"success", true}, {"message", "Route deleted successfully"}};
             res.set_content(response.dump(), "application/json");
@@ -165,13 +237,25 @@ private:
         try {
             int start = stoi(req.get_param_value("start"));
             int end = stoi(req.get_param_value("end"));
-            
-            // This would need modification to CityGraph to return path data
-            // For now, return a sample response
+            QueueKind queue = QueueKind::Radix;
+            if (req.has_param("queue") && !parseQueueKind(req.get_param_value("queue"), queue)) {
+                throw std::invalid_argument("Unknown queue");
+            }
+
+            // Dijkstra on a growable priority queue (no fixed frontier capacity)
+            RoutingGraph::PathResult result = routingGraph()->dijkstra(start, end, queue);
+            json path = json::array();
+            {
+                std::shared_lock<std::shared_mutex> lock(networkMutex);
+                for (StationId id : result.path) {
+                    auto name = stationNames.find(id);
+                    path.push_back({{"id", id}, {"name", name != stationNames.end() ? name->second : ""}});
+                }
+            }
             json response = {
-                {"success", true},
-                {"path", json::array()},
-                {"distance", 0}
+                {"success", result.found},
+                {"path", path},
+                {"distance", result.found ? result.distance : 0}
             };
             
             res.set_content(response.dump(), "application/json");
@@ -182,14 +266,23 @@ private:
         }
     }
 
+    static json traversal(StationId startId, std::vector<uint32_t> (*traverse)(const RoutingGraph&, uint32_t)) {
+        std::shared_ptr<const RoutingGraph> pinned = routingGraph();
+        const RoutingGraph& g = *pinned;
+        uint32_t start = g.indexOf(startId);
+        if (start == RoutingGraph::NONE) throw std::invalid_argument("Unknown station");
+        json ids = json::array();
+        for (uint32_t node : traverse(g, start)) ids.push_back(g.stationAt(node));
+        return ids;
+    }
+
     static void performBFS(const httplib::Request& req, httplib::Response& res) {
         try {
             int start = stoi(req.matches[1]);
             
-            // This would need modification to return traversal data
             json response = {
                 {"success", true},
-                {"traversal", json::array()}
+                {"traversal", traversal(start, GraphTraversal::bfs)}
             };
             
             res.set_content(response.dump(), "application/json");
@@ -204,10 +297,9 @@ private:
         try {
             int start = stoi(req.matches[1]);
             
-            // This would need modification to return traversal data
             json response = {
                 {"success", true},
-                {"traversal", json::array()}
+                {"traversal", traversal(start, GraphTraversal::dfs)}
             };
             
             res.set_content(response.dump(), "application/json");
@@ -223,8 +315,14 @@ private:
             json body = json::parse(req.body);
             int id = body["id"];
             string name = body["name"];
+            PassengerClass priority;
+            if (!PriorityPassengerQueue::parseClass(body.value("class", string()), priority)) {
+                throw invalid_argument("class must be accessibility, staff or regular");
+            }
+            int64_t deadline = body.contains("deadline") && !body["deadline"].is_null()
+                ? body["deadline"].get<int64_t>() : PriorityPassengerQueue::NO_DEADLINE;
             
-            pQueue.enqueue(id, name);
+            pQueue.enqueue(id, name, priority, deadline);
             
             json response = {{"success", true}, {"message", "Passenger added to queue"}};
             res.set_content(response.dump(), "application/json");
@@ -237,9 +335,19 @@ private:
 
     static void processPassenger(const httplib::Request& req, httplib::Response& res) {
         try {
-            pQueue.dequeue();
+            auto passenger = pQueue.dequeue();
+            if (!passenger) {
+                json error = {{"success", false}, {"error", "No passengers in queue"}};
+                res.set_content(error.dump(), "application/json");
+                return;
+            }
             
-            json response = {{"success", true}, {"message", "Passenger processed"}};
+            json response = {
+                {"success", true},
+                {"message", "Passenger processed"},
+                {"passenger", {{"id", passenger->id}, {"name", passenger->name},
+                               {"class", PriorityPassengerQueue::className(passenger->priority)}}}
+            };
             res.set_content(response.dump(), "application/json");
         } catch (const exception& e) {
             json error = {{"success", false}, {"error", e.what()}};
@@ -249,10 +357,14 @@ private:
     }
 
     static void getPassengerQueue(const httplib::Request& req, httplib::Response& res) {
-        // This would need modification to return queue data
+        json queue = json::array();
+        for (const auto& passenger : pQueue.peek(100)) {
+            queue.push_back({{"id", passenger.id}, {"name", passenger.name},
+                             {"class", PriorityPassengerQueue::className(passenger.priority)}});
+        }
         json response = {
             {"success", true},
-            {"queue", json::array()}
+            {"queue", queue}
         };
         
         res.set_content(response.dump(), "application/json");
@@ -264,7 +376,7 @@ private:
             int id = body["id"];
             string type = body["type"];
             
-            vTable.insert(id, type);
+            vTable.put(id, type, body.value("capacity", 0u));
             
             json response = {{"success", true}, {"message", "Vehicle added successfully"}};
             res.set_content(response.dump(), "application/json");
@@ -279,11 +391,13 @@ private:
         try {
             int id = stoi(req.matches[1]);
             
-            // This would need modification to return vehicle data
+            auto vehicle = vTable.get(id);
             json response = {
-                {"success", true},
+                {"success", vehicle.has_value()},
                 {"vehicle", nullptr}
             };
+            if (vehicle) response["vehicle"] = {{"id", vehicle->id}, {"type", vehicle->type}};
+            else response["error"] = "Vehicle not found";
             
             res.set_content(response.dump(), "application/json");
         } catch (const exception& e) {
@@ -296,7 +410,7 @@ private:
     static void removeVehicle(const httplib::Request& req, httplib::Response& res) {
         try {
             int id = stoi(req.matches[1]);
-            vTable.remove(id);
+            vTable.erase(id);
             
             json response = {{"success", true}, {"message", "Vehicle removed successfully"}};
             res.set_content(response.dump(), "application/json");
@@ -308,11 +422,15 @@ private:
     }
 
     static void getStationAnalytics(const httplib::Request& req, httplib::Response& res) {
+        json frequencies = json::array();
+        for (const auto& [station, count] : visits.totals()) {
+            frequencies.push_back({{"stationId", station}, {"visits", count}});
+        }
         json response = {
             {"success", true},
             {"analytics", {
-                {"mostCrowded", nullptr},
-                {"frequencies", json::array()}
+                {"mostCrowded", frequencies.empty() ? json(nullptr) : frequencies[0]},
+                {"frequencies", frequencies}
             }}
         };
         
@@ -336,7 +454,7 @@ private:
             json body = json::parse(req.body);
             int stationId = body["stationId"];
             
-            analytics.recordStationVisit(stationId);
+            visits.record(stationId);
             
             json response = {{"success", true}, {"message", "Visit recorded"}};
             res.set_content(response.dump(), "application/json");
@@ -353,8 +471,8 @@ private:
             {"status", {
                 {"uptime", "Running"},
                 {"stationCount", 0},
-                {"queueLength", 0},
-                {"vehicleCount", 0}
+                {"queueLength", pQueue.size()},
+                {"vehicleCount", vTable.size()}
             }}
         };
         
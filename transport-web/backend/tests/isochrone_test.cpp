@@ -0,0 +1,37 @@
+// Isochrone searches on a graph with one arc far heavier than the rest: the
+// Dial queue must be sized by the budget, not by that arc, and a budget
+// that does reach it must still be answered.
+//   make test
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+#include "Isochrone.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        std::printf("FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+int main() {
+    RoutingGraph graph;
+    graph.build({1, 2, 3, 4}, {{1, 2, 5}, {1, 4, 3}, {2, 3, 2000000000}});
+    uint32_t source = graph.indexOf(1);
+
+    auto near = Isochrone::reachable(graph, source, 10);
+    expect(near.size() == 3, "budget 10 reaches stations 1, 4 and 2");
+    expect(near.size() == 3 && graph.stationAt(near[1].first) == 4 && near[1].second == 3, "station 4 at 3");
+    expect(near.size() == 3 && graph.stationAt(near[2].first) == 2 && near[2].second == 5, "station 2 at 5");
+
+    auto far = Isochrone::reachable(graph, source, 3000000000LL);
+    expect(far.size() == 4, "large budget reaches all four stations");
+    expect(far.size() == 4 && graph.stationAt(far[3].first) == 3 && far[3].second == 2000000005,
+           "station 3 across the heavy arc at 2000000005");
+
+    std::printf("%s\n", failures ? "isochrone_test: FAILED" : "isochrone_test: ok");
+    return failures ? 1 : 0;
+}
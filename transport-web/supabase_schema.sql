@@ -4,6 +4,8 @@
 create table if not exists stations (
   id bigint primary key, -- respecting the manual ID setting from the frontend
   name text not null,
+  lat double precision check (lat between -90 and 90),
+  lon double precision check (lon between -180 and 180),
   created_at timestamp with time zone default timezone('utc'::text, now()) not null
 );
 
@@ -18,6 +20,8 @@ create table if not exists routes (
 create table if not exists vehicles (
   id bigint primary key,
   type text not null,
+  lat double precision, -- last reported position
+  lon double precision,
   created_at timestamp with time zone default timezone('utc'::text, now()) not null
 );
 
@@ -28,6 +32,12 @@ create table if not exists passengers (
   created_at timestamp with time zone default timezone('utc'::text, now()) not null
 );
 
+-- Coordinates for databases created before they were added
+alter table stations add column if not exists lat double precision check (lat between -90 and 90);
+alter table stations add column if not exists lon double precision check (lon between -180 and 180);
+alter table vehicles add column if not exists lat double precision;
+alter table vehicles add column if not exists lon double precision;
+
 -- Enable Row Level Security (RLS)
 alter table stations enable row level security;
 alter table routes enable row level security;